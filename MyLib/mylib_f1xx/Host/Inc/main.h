@@ -0,0 +1,8 @@
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32f1xx_hal.h"
+
+void Error_Handler(void);
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef __STM32F1XX_HAL_H
+#define __STM32F1XX_HAL_H
+
+/*
+ * Stand-in for the STM32F1 HAL when MyLib is built on Linux (see Host/Makefile).
+ * Only what the library uses is declared. Registers are plain memory, the UARTs, timers,
+ * DMA, ADC and flash calls do nothing or write to stdout (or to the descriptor given to
+ * Host_UartAttach), and DWT->CYCCNT counts the host monotonic clock at SystemCoreClock, so
+ * cycle figures are host time expressed in HCLK cycles.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO					volatile
+#define __weak					__attribute__((weak))
+#define HAL_ADC_MODULE_ENABLED
+
+typedef enum { HAL_OK, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+// Registers
+typedef struct { __IO uint32_t CRL, CRH, IDR, ODR, BSRR, BRR, LCKR; } GPIO_TypeDef;
+typedef struct { __IO uint32_t SR, DR, BRR, CR1, CR2, CR3, GTPR; } USART_TypeDef;
+typedef struct
+{
+	__IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+	__IO uint32_t CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR;
+} TIM_TypeDef;
+typedef struct { __IO uint32_t CCR, CNDTR, CPAR, CMAR; } DMA_Channel_TypeDef;
+typedef struct
+{
+	__IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR;
+	__IO uint32_t SQR1, SQR2, SQR3, JSQR, JDR1, JDR2, JDR3, JDR4, DR;
+} ADC_TypeDef;
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+
+extern GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC;
+extern USART_TypeDef *USART1, *USART2, *USART3;
+extern TIM_TypeDef *TIM1, *TIM2, *TIM3, *TIM4;
+extern CoreDebug_Type *CoreDebug;
+extern uint32_t SystemCoreClock;
+
+DWT_Type *Host_DWT(void);
+#define DWT						(Host_DWT())
+#define DWT_CTRL_CYCCNTENA_Msk	1u
+#define CoreDebug_DEMCR_TRCENA_Msk	(1u << 24)
+#define SCB_SCR_SLEEPDEEP_Msk	4u
+
+// Handles
+typedef struct { DMA_Channel_TypeDef *Instance; } DMA_HandleTypeDef;
+typedef enum { HAL_UART_STATE_RESET = 0, HAL_UART_STATE_READY = 0x20, HAL_UART_STATE_BUSY_TX = 0x21 } HAL_UART_StateTypeDef;
+typedef struct { uint32_t BaudRate, WordLength, StopBits, Parity, Mode, HwFlowCtl, OverSampling; } UART_InitTypeDef;
+typedef struct
+{
+	USART_TypeDef *Instance;
+	UART_InitTypeDef Init;
+	__IO HAL_UART_StateTypeDef gState;
+	DMA_HandleTypeDef *hdmatx, *hdmarx;
+} UART_HandleTypeDef;
+typedef struct { TIM_TypeDef *Instance; DMA_HandleTypeDef *hdma[7]; } TIM_HandleTypeDef;
+typedef struct { ADC_TypeDef *Instance; DMA_HandleTypeDef *DMA_Handle; } ADC_HandleTypeDef;
+typedef struct { uint32_t TypeErase, Banks, PageAddress, NbPages; } FLASH_EraseInitTypeDef;
+
+#define GPIO_PIN_0				0x0001u
+#define GPIO_PIN_1				0x0002u
+#define GPIO_PIN_15				0x8000u
+#define GPIO_PIN_All			0xFFFFu
+#define TIM_CHANNEL_1			0x0u
+#define TIM_CHANNEL_2			0x4u
+#define TIM_CHANNEL_3			0x8u
+#define TIM_CHANNEL_4			0xCu
+#define TIM_DMA_UPDATE			(1u << 8)
+#define TIM_DMA_ID_UPDATE		0
+#define TIM_IT_UPDATE			1u
+#define TIM_CR1_CEN				1u
+#define UART_WORDLENGTH_9B		0x1000u
+#define UART_PARITY_NONE		0u
+#define UART_STOPBITS_2			0x2000u
+#define FLASH_TYPEPROGRAM_HALFWORD	1u
+#define FLASH_TYPEERASE_PAGES	0u
+#define FLASH_BANK_1			1u
+#define FLASH_PAGE_SIZE			0x400u
+#define FLASH_BASE				0x08000000u
+
+#define __HAL_TIM_ENABLE_DMA(h, d)		((h)->Instance->DIER |= (d))
+#define __HAL_TIM_DISABLE_DMA(h, d)		((h)->Instance->DIER &= ~(d))
+#define __HAL_TIM_SET_COUNTER(h, c)		((h)->Instance->CNT = (c))
+#define __HAL_TIM_GET_COUNTER(h)		((h)->Instance->CNT)
+#define __HAL_TIM_SET_AUTORELOAD(h, c)	((h)->Instance->ARR = (c))
+#define __HAL_TIM_CLEAR_IT(h, f)		((h)->Instance->SR = ~(f))
+#define __HAL_DMA_GET_COUNTER(h)		((h)->Instance->CNDTR)
+
+// Core intrinsics, no interrupts on the host
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void) primask; }
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __WFI(void) {}
+static inline void __ISB(void) {}
+static inline void __DMB(void) {}
+static inline void __NOP(void) {}
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+void HAL_SuspendTick(void);
+void HAL_ResumeTick(void);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError);
+
+// Host side: virtual time of HAL_GetTick, moved by the bench
+void Host_SetTick(uint32_t tick);
+// Host side: UART traffic of the benches
+void Host_UartAttach(UART_HandleTypeDef *huart, int fd);
+int Host_UartRx(UART_HandleTypeDef *huart, uint8_t data);
+
+#endif
@@ -0,0 +1 @@
+#include "stm32f1xx_hal.h"
@@ -0,0 +1,208 @@
+#include "main.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static GPIO_TypeDef gpio[3];
+static USART_TypeDef usart[3];
+static TIM_TypeDef tim[4];
+static DWT_Type dwt;
+static CoreDebug_Type core_debug;
+
+GPIO_TypeDef *GPIOA = &gpio[0], *GPIOB = &gpio[1], *GPIOC = &gpio[2];
+USART_TypeDef *USART1 = &usart[0], *USART2 = &usart[1], *USART3 = &usart[2];
+TIM_TypeDef *TIM1 = &tim[0], *TIM2 = &tim[1], *TIM3 = &tim[2], *TIM4 = &tim[3];
+CoreDebug_Type *CoreDebug = &core_debug;
+uint32_t SystemCoreClock = 72000000;
+
+// Linker symbols of the firmware image, checked by CfgStore_Init
+uint32_t _sidata, _sdata, _edata;
+
+static uint32_t host_tick;
+static UART_HandleTypeDef *host_tx_busy;
+
+// Serial device behind each USART, -1 for stdout, and the buffer of the pending HAL_UART_Receive_IT
+static int host_uart_fd[3] = { -1, -1, -1 };
+static uint8_t *host_uart_rx[3];
+
+static int Host_UartIndex(UART_HandleTypeDef *huart)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (huart->Instance == &usart[i])
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Cycle counter: host monotonic time converted to SystemCoreClock cycles
+ */
+DWT_Type *Host_DWT(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t ns = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	dwt.CYCCNT = (uint32_t)(ns * (SystemCoreClock / 1000000) / 1000);
+	return &dwt;
+}
+
+/**
+ * @brief Move the virtual time, which also completes the UART transfer in progress
+ */
+void Host_SetTick(uint32_t tick)
+{
+	host_tick = tick;
+	if (host_tx_busy != NULL)
+	{
+		UART_HandleTypeDef *huart = host_tx_busy;
+		host_tx_busy = NULL;
+		HAL_UART_TxCpltCallback(huart);
+	}
+}
+
+/**
+ * @brief Send what the library transmits on a UART to a file descriptor (a pty for the benches)
+ */
+void Host_UartAttach(UART_HandleTypeDef *huart, int fd)
+{
+	int index = Host_UartIndex(huart);
+	if (index >= 0)
+	{
+		host_uart_fd[index] = fd;
+	}
+}
+
+/**
+ * @brief Deliver one received byte, as the RXNE interrupt completing HAL_UART_Receive_IT
+ * @return int: 0 if no reception was armed on the UART, the byte is lost as an overrun
+ */
+int Host_UartRx(UART_HandleTypeDef *huart, uint8_t data)
+{
+	int index = Host_UartIndex(huart);
+	if (index < 0 || host_uart_rx[index] == NULL)
+	{
+		return 0;
+	}
+	*host_uart_rx[index] = data;
+	host_uart_rx[index] = NULL;
+	HAL_UART_RxCpltCallback(huart);
+	return 1;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return host_tick;
+}
+
+void HAL_Delay(uint32_t delay)
+{
+	Host_SetTick(host_tick + delay);
+}
+
+void HAL_SuspendTick(void) {}
+void HAL_ResumeTick(void) {}
+void Error_Handler(void) {}
+
+uint32_t HAL_RCC_GetHCLKFreq(void)
+{
+	return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+	return SystemCoreClock / 2;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+	return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+	if (PinState == GPIO_PIN_SET)
+	{
+		GPIOx->ODR |= GPIO_Pin;
+	}
+	else
+	{
+		GPIOx->ODR &= ~GPIO_Pin;
+	}
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	fwrite(pData, 1, Size, stdout);
+	return HAL_OK;
+}
+
+// One transfer at a time, like the hardware, until Host_SetTick completes it
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+	if (host_tx_busy != NULL)
+	{
+		return HAL_BUSY;
+	}
+	int index = Host_UartIndex(huart);
+	if (index >= 0 && host_uart_fd[index] >= 0)
+	{
+		if (write(host_uart_fd[index], pData, Size) != Size)
+		{
+			return HAL_ERROR;
+		}
+	}
+	else
+	{
+		fwrite(pData, 1, Size, stdout);
+	}
+	host_tx_busy = huart;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+	return HAL_UART_Transmit_IT(huart, pData, Size);
+}
+
+// One byte at a time, which is all the library asks for
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	int index = Host_UartIndex(huart);
+	if (index >= 0)
+	{
+		host_uart_rx[index] = pData;
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim) { return HAL_OK; }
+
+// The counter does not run: CEN only tells a bench that the update interrupt is expected
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+	htim->Instance->CR1 |= TIM_CR1_CEN;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim)
+{
+	htim->Instance->CR1 &= ~TIM_CR1_CEN;
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength) { return HAL_OK; }
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma) { return HAL_OK; }
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length) { return HAL_OK; }
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc) { return HAL_OK; }
+
+// No flash on the host: the benches leave the settings store uninitialised
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) { return HAL_ERROR; }
+HAL_StatusTypeDef HAL_FLASH_Lock(void) { return HAL_OK; }
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data) { return HAL_ERROR; }
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError) { return HAL_ERROR; }
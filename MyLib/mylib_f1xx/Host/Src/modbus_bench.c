@@ -0,0 +1,238 @@
+#define _GNU_SOURCE
+#include "main.h"
+#include "modbus_rtu.h"
+#include "crc16.h"
+#include "Servo.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// termios.h names an output flag CR1, the timer register is meant here
+#undef CR1
+
+/*
+ * Drives a Modbus RTU slave through a pseudo terminal with real frames and checks the replies.
+ *   modbus_bench [baud]
+ * The slave runs in its own thread: bytes read from the pty go through HAL_UART_RxCpltCallback,
+ * and the end of frame fires when the line stays silent for the timer period Modbus_Init set
+ * (3.5 characters), measured on the host clock. The default 1200 baud gives a 32 ms t3.5, so
+ * scheduling jitter stays far below the gaps the bench plays with.
+ */
+
+#define BENCH_ADDRESS		0x11
+#define BENCH_FRAME_MAX		32
+
+typedef struct
+{
+	const char *name;
+	uint8_t req[BENCH_FRAME_MAX];		// Without the CRC
+	uint8_t req_len;
+	uint8_t reply[BENCH_FRAME_MAX];		// Without the CRC, empty if the slave must stay silent
+	uint8_t reply_len;
+	uint8_t bad_crc;
+	uint8_t split;						// Bytes sent before the gap, 0 for one write
+	uint8_t gap;						// Gap after split, in quarters of t3.5
+	uint8_t hold_tx;					// Transfers do not complete, the next reply is refused
+} bench_case_t;
+
+static const bench_case_t cases[] =
+{
+	{ "FC3 read servos", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x02 }, 6, { 0x11, 0x03, 0x04, 0x00, 0x5A, 0x00, 0x00 }, 7 },
+	{ "FC4 read temperatures", { 0x11, 0x04, 0x00, 0x00, 0x00, 0x02 }, 6, { 0x11, 0x04, 0x04, 0x80, 0x00, 0x80, 0x00 }, 7 },
+	{ "FC6 write servo", { 0x11, 0x06, 0x00, 0x0C, 0x00, 0x2D }, 6, { 0x11, 0x06, 0x00, 0x0C, 0x00, 0x2D }, 6 },
+	{ "FC16 write servos", { 0x11, 0x10, 0x00, 0x0C, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x00, 0x14 }, 11,
+	  { 0x11, 0x10, 0x00, 0x0C, 0x00, 0x02 }, 6 },
+	{ "FC3 read back", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x02 }, 6, { 0x11, 0x03, 0x04, 0x00, 0x0A, 0x00, 0x14 }, 7 },
+	{ "illegal function", { 0x11, 0x07 }, 2, { 0x11, 0x87, MODBUS_EX_ILLEGAL_FUNCTION }, 3 },
+	{ "illegal address", { 0x11, 0x03, 0x00, 0x14, 0x00, 0x01 }, 6, { 0x11, 0x83, MODBUS_EX_ILLEGAL_ADDRESS }, 3 },
+	{ "servo angle 200", { 0x11, 0x06, 0x00, 0x0C, 0x00, 0xC8 }, 6, { 0x11, 0x86, MODBUS_EX_ILLEGAL_VALUE }, 3 },
+	{ "FC16 min above max", { 0x11, 0x10, 0x00, 0x00, 0x00, 0x07, 0x0E, 0x00, 0x1E, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x00, 0x28 },
+	  21, { 0x11, 0x90, MODBUS_EX_ILLEGAL_VALUE }, 3 },
+	// The host has no flash, the limit is applied but the store refuses it
+	{ "limit not saved", { 0x11, 0x06, 0x00, 0x00, 0x00, 0x32 }, 6, { 0x11, 0x86, MODBUS_EX_DEVICE_FAILURE }, 3 },
+	{ "bad CRC", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0 }, 0, 1 },
+	{ "other slave", { 0x12, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0 }, 0 },
+	{ "broadcast write", { 0x00, 0x06, 0x00, 0x0C, 0x00, 0x1E }, 6, { 0 }, 0 },
+	{ "read after broadcast", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0x11, 0x03, 0x02, 0x00, 0x1E }, 5 },
+	{ "gap below t3.5", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0x11, 0x03, 0x02, 0x00, 0x1E }, 5, 0, 3, 1 },
+	{ "gap above t3.5", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0 }, 0, 0, 3, 12 },
+	{ "reply while idle", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0x11, 0x03, 0x02, 0x00, 0x1E }, 5, 0, 0, 0, 1 },
+	{ "reply while busy", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0 }, 0, 0, 0, 0, 1 },
+	{ "reply after busy", { 0x11, 0x03, 0x00, 0x0C, 0x00, 0x01 }, 6, { 0x11, 0x03, 0x02, 0x00, 0x1E }, 5 },
+};
+
+static UART_HandleTypeDef huart2;
+static TIM_HandleTypeDef htim2;			// Silence timer of the slave
+static TIM_HandleTypeDef htim3;			// Servo PWM
+static Servo servo[2];
+static modbus_t mb;
+static int slave_fd;
+static atomic_int bench_stop;
+static atomic_int bench_hold_tx;
+
+static uint64_t Bench_Micros(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Main loop of the slave: pty bytes, silence timer, Modbus_Process
+ */
+static void *Bench_Slave(void *arg)
+{
+	uint64_t t35 = htim2.Instance->ARR + 1;
+	uint64_t last_rx = 0;
+	uint64_t start = Bench_Micros();
+
+	while (!atomic_load(&bench_stop))
+	{
+		struct pollfd pfd = { .fd = slave_fd, .events = POLLIN };
+		struct timespec wait = { 0, 100000 };
+		uint8_t buf[64];
+
+		if (ppoll(&pfd, 1, &wait, NULL) > 0 && (pfd.revents & POLLIN))
+		{
+			ssize_t n = read(slave_fd, buf, sizeof(buf));
+			for (ssize_t i = 0; i < n; i++)
+			{
+				Host_UartRx(&huart2, buf[i]);
+			}
+			last_rx = Bench_Micros();
+		}
+		if ((htim2.Instance->CR1 & TIM_CR1_CEN) && Bench_Micros() - last_rx >= t35)
+		{
+			Modbus_TimerElapsed(&htim2);
+		}
+		Modbus_Process(&mb);
+		if (!atomic_load(&bench_hold_tx))
+		{
+			Host_SetTick((Bench_Micros() - start) / 1000);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Read a reply: wait up to 8 * t3.5 for the first byte, then until t3.5 of silence
+ */
+static int Bench_ReadReply(int fd, uint8_t *reply, int size, uint32_t t35)
+{
+	int len = 0;
+	int timeout = t35 * 8 / 1000 + 1;
+
+	for (;;)
+	{
+		struct pollfd pfd = { .fd = fd, .events = POLLIN };
+		if (poll(&pfd, 1, timeout) <= 0)
+		{
+			return len;
+		}
+		ssize_t n = read(fd, &reply[len], size - len);
+		if (n <= 0)
+		{
+			return len;
+		}
+		len += n;
+		timeout = t35 / 1000 + 1;
+	}
+}
+
+static int Bench_Run(int fd, const bench_case_t *c, uint32_t t35)
+{
+	uint8_t frame[BENCH_FRAME_MAX + 2];
+	uint8_t reply[MODBUS_FRAME_MAX];
+	uint16_t crc = Crc16_Modbus(c->req, c->req_len);
+
+	memcpy(frame, c->req, c->req_len);
+	frame[c->req_len] = crc & 0xFF;
+	frame[c->req_len + 1] = (crc >> 8) ^ (c->bad_crc ? 0x5A : 0);
+	atomic_store(&bench_hold_tx, c->hold_tx);
+
+	uint8_t first = (c->split != 0) ? c->split : c->req_len + 2;
+	if (write(fd, frame, first) != first)
+	{
+		return 0;
+	}
+	if (c->split != 0)
+	{
+		usleep(t35 * c->gap / 4);
+		if (write(fd, &frame[first], c->req_len + 2 - first) != c->req_len + 2 - first)
+		{
+			return 0;
+		}
+	}
+
+	int len = Bench_ReadReply(fd, reply, sizeof(reply), t35);
+	int ok = (c->reply_len == 0) ? (len == 0) :
+			 (len == c->reply_len + 2 && memcmp(reply, c->reply, c->reply_len) == 0 &&
+			  Crc16_Modbus(reply, c->reply_len) == (reply[c->reply_len] | (reply[c->reply_len + 1] << 8)));
+
+	printf("%-4s %-22s ->", ok ? "ok" : "FAIL", c->name);
+	for (int i = 0; i < len; i++)
+	{
+		printf(" %02X", reply[i]);
+	}
+	printf("%s\n", (len == 0) ? " (none)" : "");
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t baud = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1200;
+
+	int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0 ||
+		(slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY)) < 0)
+	{
+		perror("pty");
+		return 1;
+	}
+	struct termios tio;
+	tcgetattr(slave_fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave_fd, TCSANOW, &tio);
+
+	huart2.Instance = USART2;
+	huart2.Init.BaudRate = baud;
+	htim2.Instance = TIM2;
+	htim3.Instance = TIM3;
+	Host_UartAttach(&huart2, slave_fd);
+	SERVO_Init(&servo[0], &htim3, TIM_CHANNEL_1);
+	SERVO_Init(&servo[1], &htim3, TIM_CHANNEL_2);
+	SERVO_WRITE(&servo[0], 90);
+	SERVO_WRITE(&servo[1], 0);
+	Modbus_Init(&mb, &huart2, &htim2, BENCH_ADDRESS);
+	Modbus_AttachServo(&mb, 0, &servo[0]);
+	Modbus_AttachServo(&mb, 1, &servo[1]);
+
+	uint32_t t35 = htim2.Instance->ARR + 1;
+	pthread_t slave;
+	pthread_create(&slave, NULL, Bench_Slave, NULL);
+
+	int passed = 0;
+	int total = sizeof(cases) / sizeof(cases[0]);
+	for (int i = 0; i < total; i++)
+	{
+		passed += Bench_Run(master_fd, &cases[i], t35);
+	}
+
+	atomic_store(&bench_stop, 1);
+	pthread_join(slave, NULL);
+
+	printf("--- %lu baud, t3.5 %lu us, %d/%d passed\n", (unsigned long) baud, (unsigned long) t35, passed, total);
+	printf("frames %lu, exceptions %lu, crc errors %lu, ignored %lu, overruns %lu, tx errors %lu\n",
+		   (unsigned long) mb.stats.frames, (unsigned long) mb.stats.exceptions,
+		   (unsigned long) mb.stats.crc_errors, (unsigned long) mb.stats.ignored,
+		   (unsigned long) mb.stats.overruns, (unsigned long) mb.stats.tx_errors);
+	return (passed == total && mb.stats.tx_errors == 1 && mb.stats.crc_errors == 1) ? 0 : 1;
+}
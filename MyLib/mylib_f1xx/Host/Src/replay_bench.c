@@ -0,0 +1,74 @@
+#include "main.h"
+#include "uart.h"
+#include "cli_replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Replays a console capture through CLI_Replay_Run and prints the statistics.
+ *   replay_bench [capture [baud [poll_us]]]
+ * Without a capture file a short built-in session is used.
+ */
+
+static UART_HandleTypeDef huart1;
+
+static const char sample[] =
+	"getTemp 1\n"
+	"setTempMax 1 80; getTemp 1\n"
+	"getTemp 2\n"
+	"alarm\n"
+	"getTemp 3\n";
+
+int main(int argc, char **argv)
+{
+	static uint8_t capture[65536];
+	static uint8_t out[65536];
+	uint32_t len = sizeof(sample) - 1;
+
+	if (argc > 1)
+	{
+		FILE *f = fopen(argv[1], "rb");
+		if (f == NULL)
+		{
+			perror(argv[1]);
+			return 1;
+		}
+		len = fread(capture, 1, sizeof(capture), f);
+		fclose(f);
+	}
+	else
+	{
+		memcpy(capture, sample, len);
+	}
+
+	cli_replay_cfg_t cfg = { 0 };
+	cfg.baud = (argc > 2) ? strtoul(argv[2], NULL, 0) : 115200;
+	cfg.poll_us = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0;
+	cfg.out_buf = out;
+	cfg.out_size = sizeof(out);
+
+	huart1.Instance = USART1;
+	UART_Init(&huart1);
+
+	cli_replay_stats_t stats;
+	if (CLI_Replay_Run(CLI_FromUart(&huart1), capture, len, &cfg, &stats) != HAL_OK)
+	{
+		fprintf(stderr, "baud must be 0 or at least %u\n", CLI_REPLAY_BAUD_MIN);
+		return 1;
+	}
+
+	fwrite(out, 1, stats.out_len, stdout);
+	printf("\n--- baud %lu, poll %lu us\n", (unsigned long) cfg.baud, (unsigned long) cfg.poll_us);
+	printf("bytes in %lu out %lu, wire %lu us\n", (unsigned long) stats.bytes_in,
+		   (unsigned long) stats.bytes_out, (unsigned long) stats.wire_us);
+	printf("rx peak %u dropped %lu\n", stats.rx_peak, (unsigned long) stats.rx_dropped);
+	printf("commands %lu, %lu/s at HCLK\n", (unsigned long) stats.commands, (unsigned long) stats.commands_per_s);
+	if (stats.commands != 0)
+	{
+		printf("latency us min %lu avg %lu max %lu\n", (unsigned long) stats.latency_min_us,
+			   (unsigned long)(stats.latency_total_us / stats.commands), (unsigned long) stats.latency_max_us);
+	}
+	return 0;
+}
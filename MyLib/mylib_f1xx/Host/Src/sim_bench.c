@@ -0,0 +1,86 @@
+#include "main.h"
+#include "button_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Runs ButtonSim_Run over a bank of simulated buttons and prints the counters.
+ *   sim_bench [buttons [bounces]]
+ * Button 0 does a short press, a double press and a long hold. All the others are pressed
+ * together with bouncing contacts, held past the very long threshold and released together.
+ */
+
+#define SIM_TRACE_MAX		2048
+#define SIM_EVENTS_MAX		8192
+#define SIM_DURATION		6000
+
+static Button_t buttons[BTN_SIM_BUTTONS];
+static ButtonSimEdge_t trace[SIM_TRACE_MAX];
+static ButtonSimEvent_t events[SIM_EVENTS_MAX];
+
+static const char *event_name[] = { "none", "pressed", "released", "short", "long", "very long", "double", "hold" };
+
+static int SimBench_CompareEdge(const void *a, const void *b)
+{
+	const ButtonSimEdge_t *ea = a, *eb = b;
+	return (ea->tick > eb->tick) - (ea->tick < eb->tick);
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t count = (argc > 1) ? atoi(argv[1]) : 120;
+	uint8_t bounces = (argc > 2) ? atoi(argv[2]) : 3;
+	uint16_t len = 0;
+
+	if (count == 0 || count > BTN_SIM_BUTTONS)
+	{
+		count = BTN_SIM_BUTTONS;
+	}
+	for (uint8_t i = 0; i < count; i++)
+	{
+		Button_Init(&buttons[i], GPIOA, GPIO_PIN_0, BUTTON_ACTIVE_LOW);
+	}
+
+	// Levels are raw pin levels: active low, 0 = pressed
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 100, 0, 0, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 200, 0, 1, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 700, 0, 0, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 800, 0, 1, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 900, 0, 0, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 1000, 0, 1, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 1500, 0, 0, bounces, 1);
+	len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 3000, 0, 1, bounces, 1);
+	for (uint8_t i = 1; i < count; i++)
+	{
+		len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 2000, i, 0, bounces, 2);
+		len = ButtonSim_AddBounce(trace, len, SIM_TRACE_MAX, 5500, i, 1, bounces, 2);
+	}
+	qsort(trace, len, sizeof(trace[0]), SimBench_CompareEdge);
+
+	ButtonSimResult_t result;
+	ButtonSim_Run(buttons, count, trace, len, 0xFFFFF000u, SIM_DURATION, events, SIM_EVENTS_MAX, &result);
+
+	uint32_t per_event[8] = { 0 };
+	uint32_t stored = (result.events < SIM_EVENTS_MAX) ? result.events : SIM_EVENTS_MAX;
+	for (uint32_t i = 0; i < stored; i++)
+	{
+		if (events[i].button == 0)
+		{
+			printf("%5lu  button 0 %s (+%u)\n", (unsigned long) events[i].tick,
+				   event_name[events[i].event], events[i].latency);
+		}
+		per_event[events[i].event]++;
+	}
+
+	printf("--- %u buttons, %u bounces, %u edges, %u ticks\n", count, bounces, len, SIM_DURATION);
+	for (uint8_t e = BUTTON_EVENT_PRESSED; e <= BUTTON_EVENT_HOLD; e++)
+	{
+		printf("%-10s %lu\n", event_name[e], (unsigned long) per_event[e]);
+	}
+	printf("events %lu, dropped %lu\n", (unsigned long) result.events, (unsigned long) result.dropped);
+	printf("Button_Handle cycles avg %lu max %lu\n", (unsigned long)(result.cycles_total / result.calls),
+		   (unsigned long) result.cycles_max);
+	printf("press/release latency %u..%u ticks\n", result.latency_min, result.latency_max);
+	return 0;
+}
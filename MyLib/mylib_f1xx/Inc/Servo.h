@@ -7,9 +7,11 @@
 typedef struct {
     TIM_HandleTypeDef *htim;
     uint16_t CHANNEL;
+    uint8_t angle;      // Last angle written
 } Servo;
 
 void SERVO_Init(Servo *sv, TIM_HandleTypeDef *htim, uint16_t CHANNEL);
 void SERVO_WRITE(Servo *sv, uint8_t ANGLE);
+uint8_t SERVO_READ(Servo *sv);
 
 #endif /* __SERVO_H__ */
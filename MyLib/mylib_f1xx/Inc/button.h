@@ -2,8 +2,9 @@
 #define BUTTON_H
 
 #include "stm32f1xx_hal.h"
+#include "soft_timer.h"
 
-// Timing thresholds for different button events (in milliseconds)
+// Default timing thresholds for different button events (in milliseconds)
 #define BTN_SHORT_THRESHOLD         300   // Max duration for a short press
 #define BTN_LONG_THRESHOLD          1000  // Minimum duration for a long press
 #define BTN_VERY_LONG_THRESHOLD     3000  // Minimum duration for a very long press
@@ -11,6 +12,10 @@
 #define BTN_HOLD_INTERVAL           200   // Interval between repeated hold callbacks
 #define BTN_DEBOUNCE_TIME			15	  // Button debounce time
 
+#ifndef BTN_QUEUE_SIZE
+#define BTN_QUEUE_SIZE              16    // Event queue records, power of two
+#endif
+
 // Button active level type
 typedef enum {
     BUTTON_ACTIVE_LOW,   // Pull-up configuration (pressed = LOW)
@@ -29,6 +34,33 @@ typedef enum {
     BUTTON_EVENT_HOLD
 } ButtonEvent;
 
+#define BUTTON_EVENT_MASK(event)    (1U << ((event) - 1))
+#define BUTTON_EVENT_ALL            0x7F
+
+// Event queue record
+typedef struct {
+    uint8_t id;                  // Button identifier given to Button_EnableQueue
+    uint8_t event;               // ButtonEvent
+    uint16_t repeat;             // Hold events since the press (HOLD only)
+    uint32_t tick;               // Timestamp of the event
+} ButtonEventRecord_t;
+
+// Per-button timing thresholds (in milliseconds)
+typedef struct {
+    uint16_t short_ms;           // Max duration for a short press
+    uint16_t long_ms;            // Minimum duration for a long press
+    uint16_t very_long_ms;       // Minimum duration for a very long press
+    uint16_t double_ms;          // Max interval between two presses for a double press
+    uint16_t hold_ms;            // Interval between repeated hold callbacks
+    uint16_t debounce_ms;        // Debounce time
+} ButtonTiming_t;
+
+// Hold-repeat acceleration: delay before each hold event, from a precomputed table
+typedef struct {
+    const uint16_t* interval;    // interval[0] is the initial delay, the last entry is the floor, none 0
+    uint8_t length;              // Entries in interval
+} ButtonRepeatProfile_t;
+
 // Main button structure
 typedef struct {
     GPIO_TypeDef* GPIOx;         // GPIO port (e.g., GPIOA, GPIOB)
@@ -55,6 +87,17 @@ typedef struct {
     uint8_t press_count;             // Number of consecutive presses (for double press)
     uint32_t last_press_time;        // Timestamp of the previous press (for double press)
 
+    // Deadline scheduling
+    ButtonTiming_t timing;           // Thresholds, BTN_* defaults after Button_Init
+    SoftTimer_t timer;               // Next long/very long/hold deadline or edge debounce
+    const ButtonRepeatProfile_t* repeat_profile; // Hold intervals, NULL = fixed timing.hold_ms
+    uint16_t repeat;                 // Hold events since the press
+    uint8_t edge_debounce;           // Timer runs the debounce started by Button_Edge
+
+    // Event queue mode
+    uint8_t id;                      // Identifier in queued records
+    uint8_t queue_events;            // Queued events mask, 0 = callback mode
+
     // Callback function pointers for events
     void (*pressed_callback)(void);          // Called when button is pressed
     void (*released_callback)(void);         // Called when button is released
@@ -65,12 +108,44 @@ typedef struct {
     void (*hold_callback)(void);             // Called continuously while button is held
 } Button_t;
 
+// Tickless mode counters
+typedef struct {
+    uint32_t sleeps;             // Times the MCU entered WFI with SysTick suspended
+    uint32_t ticked;             // Times it entered WFI with SysTick running (timer armed or keep_tick)
+    uint32_t wakeups;            // Button edges that ended a sleep
+    uint32_t skipped;            // Sleeps skipped because an edge was pending
+} ButtonPowerStats_t;
+
 // Function prototypes
 void Button_Init(Button_t* p_button, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, ButtonActiveLevel active_level);
 void Button_SetCallback(Button_t* p_button, ButtonEvent event, void (*callback)(void));
+void Button_SetTiming(Button_t* p_button, const ButtonTiming_t* timing);
+void Button_SetReadHook(uint8_t (*read)(Button_t* p_button));
+void Button_SetRepeatProfile(Button_t* p_button, const ButtonRepeatProfile_t* profile);
+uint16_t Button_GetRepeat(Button_t* p_button);
+uint8_t Button_BuildRepeatProfile(uint16_t* table, uint8_t size, uint16_t initial_ms,
+                                  uint16_t start_ms, uint16_t floor_ms, uint8_t steps);
+void Button_EnableQueue(Button_t* p_button, uint8_t id, uint8_t events);
+uint8_t Button_PopEvent(ButtonEventRecord_t* record);
+uint32_t Button_QueueDropped(void);
 uint8_t Button_Debounce(Button_t* p_button, uint32_t current_tick);
 void Button_Handle(Button_t* p_button, uint32_t current_tick);
+void Button_Update(Button_t* p_button, uint8_t state_changed, uint32_t current_tick);
+void Button_Edge(Button_t* p_button, uint32_t current_tick);
 uint8_t Button_IsPressed(Button_t* p_button);
 uint8_t Button_GetEvent(Button_t* p_button, ButtonEvent event);
 
+// Tickless mode: poll while a button is active, sleep until the next EXTI edge otherwise.
+// Pass keep_tick = 1 while other HAL_GetTick based work is pending (a settings commit, CLI
+// watches, a running command): the MCU then wakes on every SysTick. Button_Handle fires the
+// press deadlines itself, SoftTimer_Process is for Button_Edge, ButtonBank and other timers.
+//   while (1) {
+//       Button_Handle(&btn, HAL_GetTick());
+//       if (Button_IsIdle(&btn)) Button_Sleep(0);
+//   }
+uint8_t Button_IsIdle(Button_t* p_button);
+void Button_EXTI_Callback(uint16_t GPIO_Pin);
+uint8_t Button_Sleep(uint8_t keep_tick);
+void Button_GetPowerStats(ButtonPowerStats_t* stats);
+
 #endif /* BUTTON_H */
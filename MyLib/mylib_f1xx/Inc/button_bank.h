@@ -0,0 +1,44 @@
+#ifndef BUTTON_BANK_H
+#define BUTTON_BANK_H
+
+#include "button.h"
+
+#define BTN_BANK_PORTS          2     // GPIO ports per bank
+#define BTN_BANK_SCAN_PERIOD    4     // Scan period (ms), a change is accepted after 4 equal scans
+#ifndef BTN_BANK_BENCHMARK
+#define BTN_BANK_BENCHMARK      0     // Build ButtonBank_Benchmark (needs about 2 KB of RAM)
+#endif
+
+// All buttons of one GPIO port, debounced together with 2-bit vertical counters
+typedef struct {
+    GPIO_TypeDef* GPIOx;
+    uint16_t mask;               // Pins in use
+    uint16_t active_low;         // Pins pressed when low
+    uint16_t state;              // Debounced state, 1 = pressed
+    uint16_t ct0;                // Vertical counter, bit 0 of each pin
+    uint16_t ct1;                // Vertical counter, bit 1 of each pin
+    Button_t* button[16];        // Event logic of each pin
+} ButtonPort_t;
+
+typedef struct {
+    ButtonPort_t port[BTN_BANK_PORTS];
+    uint8_t port_count;
+    uint32_t next_scan;
+} ButtonBank_t;
+
+typedef struct {
+    uint8_t buttons;
+    uint32_t cycles_single;      // Button_Handle on every button
+    uint32_t cycles_bank;        // ButtonBank_Scan
+} ButtonBenchmark_t;
+
+void ButtonBank_Init(ButtonBank_t* bank);
+uint8_t ButtonBank_Add(ButtonBank_t* bank, Button_t* p_button);
+void ButtonBank_Scan(ButtonBank_t* bank, uint32_t current_tick);
+void ButtonBank_PortSample(ButtonPort_t* port, uint16_t idr, uint32_t current_tick);
+uint8_t ButtonBank_IsIdle(ButtonBank_t* bank);
+#if BTN_BANK_BENCHMARK
+void ButtonBank_Benchmark(ButtonBenchmark_t result[3]);
+#endif
+
+#endif /* BUTTON_BANK_H */
@@ -0,0 +1,32 @@
+#ifndef BUTTON_DMA_H
+#define BUTTON_DMA_H
+
+#include "button_bank.h"
+
+#ifndef BTN_DMA_BUFFER
+#define BTN_DMA_BUFFER          32    // Samples in the circular buffer, drained within BTN_DMA_BUFFER - 1 periods
+#endif
+
+// One bank port sampled by a timer update DMA request: TIMx_UP copies GPIOx->IDR into
+// buffer at a fixed rate, the main loop debounces the new samples in batches.
+// CubeMX: TIMx update DMA, peripheral to memory, circular, half-word, no increment on the
+// peripheral side (e.g. TIM2_UP = DMA1 channel 2, TIM3_UP = channel 3, TIM4_UP = channel 7).
+typedef struct {
+    ButtonPort_t* port;          // Port of the bank that owns the pins
+    TIM_HandleTypeDef* htim;
+    DMA_HandleTypeDef* hdma;
+    uint16_t buffer[BTN_DMA_BUFFER];
+    uint16_t read;               // Next sample to process
+    uint8_t period_ms;           // Timer period, one sample per period
+    uint32_t sample_tick;        // Tick of the next sample to process, re-synced every batch
+    uint32_t last_tick;          // Tick of the last ButtonDma_Process
+    uint32_t samples;            // Samples processed
+    uint32_t overruns;           // Batches late enough for the DMA to have lapped the reader
+} ButtonDma_t;
+
+// Function prototypes
+HAL_StatusTypeDef ButtonDma_Start(ButtonDma_t* dma, ButtonPort_t* port, TIM_HandleTypeDef* htim, uint8_t period_ms);
+void ButtonDma_Stop(ButtonDma_t* dma);
+void ButtonDma_Process(ButtonDma_t* dma, uint32_t current_tick);
+
+#endif // BUTTON_DMA_H
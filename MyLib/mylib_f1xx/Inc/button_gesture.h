@@ -0,0 +1,59 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include "button.h"
+
+#ifndef GESTURE_MAX
+#define GESTURE_MAX             16    // Gestures per engine
+#endif
+#ifndef GESTURE_BUTTONS
+#define GESTURE_BUTTONS         16    // Button ids 0..GESTURE_BUTTONS-1
+#endif
+#define GESTURE_CLICK_TIME      300   // Max press duration of a click (ms)
+#define GESTURE_GAP_TIME        300   // Max gap between the clicks of a sequence (ms)
+
+typedef enum {
+    GESTURE_TYPE_CLICKS,         // N clicks of one button
+    GESTURE_TYPE_CLICK_HOLD,     // N clicks, then press and hold
+    GESTURE_TYPE_CHORD           // Two buttons held together
+} GestureType;
+
+// One row of the gesture table
+typedef struct {
+    uint8_t type;                // GestureType
+    uint8_t button;              // Button id
+    uint8_t button2;             // Second button of a chord
+    uint8_t clicks;              // Clicks (before the hold for CLICK_HOLD)
+    uint16_t time_ms;            // Hold time for CLICK_HOLD and CHORD
+} ButtonGesture_t;
+
+#define GESTURE_CLICKS(button, n)               { GESTURE_TYPE_CLICKS, (button), 0, (n), 0 }
+#define GESTURE_CLICK_HOLD(button, n, ms)       { GESTURE_TYPE_CLICK_HOLD, (button), 0, (n), (ms) }
+#define GESTURE_CHORD(button, button2, ms)      { GESTURE_TYPE_CHORD, (button), (button2), 0, (ms) }
+
+// Click tracking of one button
+typedef struct {
+    uint32_t press_time;
+    uint32_t release_time;
+    uint8_t clicks;              // Clicks of the current sequence
+    uint8_t pressed;
+} GestureButton_t;
+
+typedef struct {
+    const ButtonGesture_t* table;
+    uint8_t count;
+    uint16_t index[GESTURE_BUTTONS];    // Gestures using each button
+    uint16_t wait;                      // CLICKS gestures that a longer gesture may still extend
+    uint16_t armed;                     // Gestures with a deadline
+    uint32_t deadline[GESTURE_MAX];
+    GestureButton_t button[GESTURE_BUTTONS];
+    SoftTimer_t timer;
+    void (*handler)(uint8_t gesture);   // Called with the table index
+} ButtonGestureEngine_t;
+
+// Function prototypes
+void ButtonGesture_Init(ButtonGestureEngine_t* engine, const ButtonGesture_t* table, uint8_t count,
+                        void (*handler)(uint8_t));
+void ButtonGesture_Event(ButtonGestureEngine_t* engine, uint8_t id, ButtonEvent event, uint32_t current_tick);
+
+#endif // BUTTON_GESTURE_H
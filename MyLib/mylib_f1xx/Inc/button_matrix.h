@@ -0,0 +1,47 @@
+#ifndef BUTTON_MATRIX_H
+#define BUTTON_MATRIX_H
+
+#include "button_panel.h"
+
+#define BTN_MATRIX_ROWS         8     // Max rows, key id = row * 8 + column
+#define BTN_MATRIX_COLS         8     // Max columns
+#define BTN_MATRIX_SCAN_PERIOD  2     // Scan period (ms), a change is accepted after 4 equal scans
+#define BTN_MATRIX_SETTLE_NS    2000  // Default wait between driving a row and reading the columns
+
+// Keypad matrix: rows are open-drain outputs of one port, columns are pulled-up inputs
+// on consecutive pins of one port. A key pulls its column low while its row is driven low.
+// After a row is released, a column it pulled low recharges through the pull-up (about
+// 40 kOhm inside the STM32, roughly 1 us with the wiring capacitance). The columns are read
+// only after the settle time, otherwise a key also shows up on the next row. Use a longer
+// settle time for long cables or weaker pull-ups.
+typedef struct {
+    GPIO_TypeDef* row_port;
+    uint16_t row_pin[BTN_MATRIX_ROWS];  // Pin mask of each row
+    uint16_t row_mask;                  // All row pins
+    uint8_t rows;
+    GPIO_TypeDef* col_port;
+    uint8_t col_shift;                  // Pin number of column 0
+    uint8_t cols;
+    uint16_t settle;                    // CPU cycles between driving a row and reading
+    uint8_t diodes;                     // 1 if every key has a diode (no ghosting)
+
+    uint8_t raw[BTN_MATRIX_ROWS];       // Last sample, 1 = pressed
+    uint32_t state[2];                  // Debounced state, key id bit
+    uint32_t ct0[2];                    // Vertical counter, bit 0
+    uint32_t ct1[2];                    // Vertical counter, bit 1
+    volatile uint8_t changed;           // State changed since the last ButtonMatrix_Process
+    uint32_t ghost_scans;               // Scans where ambiguous rows were held back
+    uint32_t scan_cycles;               // CPU cycles of the last ButtonMatrix_Sample
+    uint32_t next_scan;
+    ButtonPanel_t* panel;               // Event logic of the keys
+} ButtonMatrix_t;
+
+// Function prototypes
+void ButtonMatrix_Init(ButtonMatrix_t* matrix, ButtonPanel_t* panel,
+                       GPIO_TypeDef* row_port, const uint16_t* row_pins, uint8_t rows,
+                       GPIO_TypeDef* col_port, uint8_t col_shift, uint8_t cols, uint16_t settle_ns);
+void ButtonMatrix_Sample(ButtonMatrix_t* matrix);
+void ButtonMatrix_Process(ButtonMatrix_t* matrix, uint32_t current_tick);
+void ButtonMatrix_Scan(ButtonMatrix_t* matrix, uint32_t current_tick);
+
+#endif // BUTTON_MATRIX_H
@@ -0,0 +1,41 @@
+#ifndef BUTTON_PANEL_H
+#define BUTTON_PANEL_H
+
+#include "button.h"
+
+#ifndef BTN_PANEL_KEYS
+#define BTN_PANEL_KEYS          64    // Keys per panel, multiple of 32
+#endif
+#define BTN_PANEL_WORDS         (BTN_PANEL_KEYS / 32)
+
+// Compact state of one key: 8 bytes, timestamps are the low 16 bits of the tick
+typedef struct {
+    uint16_t press_time;         // Tick of the last press, also for double press
+    uint16_t hold_time;          // Tick of the last hold event (or of the press)
+    uint16_t repeat;             // Hold events since the press
+    uint16_t pressed : 1;        // Key is down
+    uint16_t long_sent : 1;      // Long press was reported
+    uint16_t very_long_sent : 1; // Very long press was reported
+    uint16_t double_wait : 1;    // One press seen, waiting for a second one
+    uint16_t reserved : 12;
+} ButtonKey_t;
+
+// Keys sharing one timing, one handler and one deadline timer
+typedef struct {
+    ButtonKey_t key[BTN_PANEL_KEYS];
+    uint32_t pressed[BTN_PANEL_WORDS];  // Debounced state, 1 = pressed
+    uint32_t active[BTN_PANEL_WORDS];   // Keys with a deadline (down or waiting for double)
+    uint8_t count;                      // Keys in use
+    uint8_t hold;                       // Report BUTTON_EVENT_HOLD
+    ButtonTiming_t timing;              // Thresholds, should stay below 32 s
+    const ButtonRepeatProfile_t* repeat_profile; // Hold intervals, NULL = fixed timing.hold_ms
+    SoftTimer_t timer;                  // Earliest deadline of all keys
+    void (*handler)(uint8_t id, ButtonEvent event);
+} ButtonPanel_t;
+
+// Function prototypes
+void ButtonPanel_Init(ButtonPanel_t* panel, uint8_t count, void (*handler)(uint8_t, ButtonEvent));
+void ButtonPanel_Update(ButtonPanel_t* panel, uint8_t word, uint32_t state, uint32_t current_tick);
+void ButtonPanel_Process(ButtonPanel_t* panel, uint32_t current_tick);
+
+#endif // BUTTON_PANEL_H
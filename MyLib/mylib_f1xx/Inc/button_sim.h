@@ -0,0 +1,47 @@
+#ifndef BUTTON_SIM_H
+#define BUTTON_SIM_H
+
+#include "button.h"
+
+#ifndef BTN_SIM_ENABLE
+#define BTN_SIM_ENABLE          0     // Build the trace simulator (needs about 1 KB of RAM)
+#endif
+#define BTN_SIM_BUTTONS         128   // Max simulated buttons
+#ifndef BTN_SIM_CYCLES
+#define BTN_SIM_CYCLES()        (DWT->CYCCNT)   // Cycle counter, a host build can use its own
+#endif
+
+// One edge of a trace: the raw pin level of a button from a tick on (offset from the start)
+typedef struct {
+    uint32_t tick;
+    uint8_t button;              // Index in the simulated array
+    uint8_t level;               // Raw pin level
+} ButtonSimEdge_t;
+
+// One detected event
+typedef struct {
+    uint32_t tick;               // Offset from the start
+    uint8_t button;
+    uint8_t event;               // ButtonEvent
+    uint16_t latency;            // Ticks since the last edge of the button
+} ButtonSimEvent_t;
+
+typedef struct {
+    uint32_t events;             // Events detected (may exceed the events array)
+    uint32_t dropped;            // Events lost in the button queue
+    uint32_t calls;              // Button_Handle calls
+    uint32_t cycles_total;       // Cycles of all Button_Handle calls
+    uint32_t cycles_max;         // Worst single call
+    uint16_t latency_min;        // PRESSED/RELEASED latency from the last edge
+    uint16_t latency_max;
+} ButtonSimResult_t;
+
+#if BTN_SIM_ENABLE
+uint16_t ButtonSim_AddBounce(ButtonSimEdge_t* trace, uint16_t len, uint16_t size, uint32_t tick,
+                             uint8_t button, uint8_t level, uint8_t bounces, uint8_t spacing);
+void ButtonSim_Run(Button_t* buttons, uint8_t count, const ButtonSimEdge_t* trace, uint16_t trace_len,
+                   uint32_t start_tick, uint32_t duration,
+                   ButtonSimEvent_t* events, uint16_t max_events, ButtonSimResult_t* result);
+#endif
+
+#endif // BUTTON_SIM_H
@@ -0,0 +1,58 @@
+#ifndef __CFG_STORE_H
+#define __CFG_STORE_H
+
+#include "main.h"
+
+#include <stdint.h>
+
+/*
+ * Two 1 KB pages at the end of a 64 KB STM32F103. They must be excluded from the application
+ * in the linker script, by ending FLASH before them:
+ *
+ *   FLASH (rx) : ORIGIN = 0x8000000, LENGTH = 62K
+ *
+ * The linker then fails when the image grows into the pages. CfgStore_Init also checks the
+ * end of the image (_sidata plus the size of .data) and leaves the pages alone if it reaches them.
+ */
+#define CFG_STORE_PAGE0			0x0800F800UL
+#define CFG_STORE_PAGE1			0x0800FC00UL
+#define CFG_STORE_PAGE_SIZE		0x400UL
+
+#define CFG_STORE_KEYS			16		// Keys 0..CFG_STORE_KEYS-1, indexed directly in RAM
+#define CFG_STORE_COMMIT_DELAY	200		// Quiet time after the last change before it is written (ms)
+#define CFG_STORE_RETRY_MIN		1000	// First retry after a failed commit (ms), doubled on each failure
+#define CFG_STORE_RETRY_MAX		60000	// Longest retry backoff (ms)
+
+// Keys of the stored settings
+#define CFG_KEY_TEMP_MAX		0		// + channel, 6 channels
+#define CFG_KEY_TEMP_MIN		6		// + channel, 6 channels
+
+// Page status, programmed in the first half-word of a page
+#define CFG_PAGE_ERASED			0xFFFF
+#define CFG_PAGE_RECEIVE		0xEEEE	// Being filled by a transfer
+#define CFG_PAGE_VALID			0x0000	// Holds the current records
+
+typedef struct
+{
+	uint32_t scan_cycles;		// Startup scan of the valid page (DWT cycles)
+	uint16_t records;			// Records in the valid page
+	uint16_t free_slots;		// Records that can still be appended
+	uint32_t sets;				// CfgStore_Set calls that changed a value
+	uint32_t commits;			// Flash programming sessions
+	uint32_t writes;			// Records programmed
+	uint32_t transfers;			// Page swaps, each erases one page
+	uint32_t errors;			// Flash operations that failed
+	uint32_t pending;			// Keys changed in RAM and not yet in flash, one bit per key
+	uint8_t failed;				// Latched by a failed commit, cleared by the next good one
+	uint32_t retry_delay;		// Backoff before CfgStore_Process retries, while failed
+} cfg_store_stats_t;
+
+HAL_StatusTypeDef CfgStore_Init(void);
+uint8_t CfgStore_Get(uint16_t key, int16_t *value);
+HAL_StatusTypeDef CfgStore_Set(uint16_t key, int16_t value);
+void CfgStore_Process(uint32_t tick);
+HAL_StatusTypeDef CfgStore_Flush(void);
+void CfgStore_GetStats(cfg_store_stats_t *stats);
+void CfgStore_Command(char **argv, uint8_t arr_token);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __CLI_EDIT_H
+#define __CLI_EDIT_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+#ifndef CLI_HISTORY_SIZE
+#define CLI_HISTORY_SIZE	256			// Bytes of the history ring, per console (power of two)
+#endif
+#define CLI_PROMPT			"> "
+
+// Interactive line editor of one console
+typedef struct
+{
+	uint8_t interactive;			// Echo, editing keys, history and completion enabled
+	uint8_t cursor;					// Position of the cursor in the line
+	uint8_t esc_state;				// Progress through an ANSI escape sequence
+	uint8_t last_cr;				// Previous key was CR, ignore the LF of a CRLF
+	uint8_t browse;					// History entry shown, 0 when editing a new line
+
+	// History: NUL terminated entries packed in a ring, oldest bytes dropped first
+	char history[CLI_HISTORY_SIZE];
+	uint16_t hist_start;
+	uint16_t hist_end;
+	uint8_t hist_count;
+} cli_edit_t;
+
+void CLI_Edit_Byte(cli_t *cli, uint8_t data);
+void CLI_SetInteractive(cli_t *cli, uint8_t enable);
+void CLI_Term(char **argv, uint8_t arr_token);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __CLI_PERF_H
+#define __CLI_PERF_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+// Set to 1 to compile the per-command profiling in, it costs about 72 bytes of RAM per
+// profiled command and console
+#ifndef CLI_PERF_ENABLE
+#define CLI_PERF_ENABLE			0
+#endif
+
+#ifndef CLI_PERF_MAX_COMMANDS
+#define CLI_PERF_MAX_COMMANDS	16		// Table entries profiled, later entries are ignored
+#endif
+
+typedef enum
+{
+	CLI_PERF_PARSE = 0,		// Splitting the line or decoding the RPC arguments
+	CLI_PERF_LOOKUP,		// Finding the command in the table
+	CLI_PERF_HANDLER,		// Handler, without the time spent printing
+	CLI_PERF_OUTPUT,		// PRINT_CLI calls made by the handler
+	CLI_PERF_PHASES
+} cli_perf_phase_id_t;
+
+typedef struct
+{
+	uint64_t total;
+	uint32_t min;
+	uint32_t max;
+} cli_perf_phase_t;
+
+typedef struct
+{
+	uint32_t calls;
+	uint32_t out_bytes;
+	cli_perf_phase_t phase[CLI_PERF_PHASES];
+} cli_perf_entry_t;
+
+// Profile of one console, entry[i] belongs to commands[i]. A resumable (step) command is
+// recorded once per step: calls counts steps, parse and lookup are 0 for them. Parse is 0
+// for every command: the stream parser splits the tokens while the bytes arrive.
+typedef struct
+{
+	cli_perf_entry_t entry[CLI_PERF_MAX_COMMANDS];
+	uint32_t out_cycles;	// Running totals of PRINT_CLI, sampled around each handler
+	uint32_t out_bytes;
+} cli_perf_t;
+
+#if CLI_PERF_ENABLE
+#define CLI_PERF_MARK(t)				uint32_t t = CLI_CYCLES()
+#define CLI_PERF_SPAN(from, to)			((to) - (from))
+#define CLI_PERF_OUTPUT(cli, t, bytes)	do { (cli)->perf.out_cycles += CLI_CYCLES() - (t); (cli)->perf.out_bytes += (bytes); } while (0)
+#define CLI_PERF_RECORD(cli, command, parse, lookup, t_handler, t_end, out_cycles, out_bytes) \
+	CLI_Perf_Record((cli), (command), (parse), (lookup), (t_end) - (t_handler), \
+					(cli)->perf.out_cycles - (out_cycles), (cli)->perf.out_bytes - (out_bytes))
+
+void CLI_Perf_Record(cli_t *cli, const cli_command_t *command, uint32_t parse, uint32_t lookup,
+					 uint32_t handler, uint32_t output, uint32_t out_bytes);
+cli_task_status_t CLI_Perf(cli_task_t *task);
+#else
+#define CLI_PERF_MARK(t)
+#define CLI_PERF_SPAN(from, to)			0
+#define CLI_PERF_OUTPUT(cli, t, bytes)
+#define CLI_PERF_RECORD(cli, command, parse, lookup, t_handler, t_end, out_cycles, out_bytes)
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __CLI_REPLAY_H
+#define __CLI_REPLAY_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+#define CLI_REPLAY_BAUD_MIN		300		// Slowest virtual line rate CLI_Replay_Run accepts
+
+// How a capture is fed back into a console
+typedef struct
+{
+	uint32_t baud;			// Virtual line rate, 10 bits per byte, 0 = bytes back to back
+	uint32_t poll_us;		// Virtual period of the loop calling CLI_Handle, 0 = after every byte
+	uint8_t *out_buf;		// Optional copy of everything the console printed, may be NULL
+	uint32_t out_size;
+} cli_replay_cfg_t;
+
+typedef struct
+{
+	uint32_t bytes_in;
+	uint32_t bytes_out;
+	uint32_t out_len;			// Bytes stored in out_buf
+	uint32_t commands;			// Lines completed by a '\n'
+	uint32_t rx_dropped;		// Bytes lost because the RX queue was full
+	uint16_t rx_peak;			// Deepest RX queue seen
+	uint32_t wire_us;			// Time the capture takes on the wire at the chosen baud
+
+	// CPU cost of CLI_Handle (DWT cycles)
+	uint64_t cycles;
+	uint32_t commands_per_s;	// At HCLK, if the CPU did nothing else
+
+	// Per command, in virtual time: from its '\n' arriving to the end of the pass that ran it.
+	// Includes the wait for poll_us and for the passes still busy with earlier commands.
+	uint32_t latency_min_us;
+	uint32_t latency_max_us;
+	uint64_t latency_total_us;
+} cli_replay_stats_t;
+
+void CLI_Replay_RecordBegin(cli_t *cli, uint8_t *buf, uint16_t size);
+uint16_t CLI_Replay_RecordEnd(cli_t *cli);
+HAL_StatusTypeDef CLI_Replay_Run(cli_t *cli, const uint8_t *capture, uint32_t len, const cli_replay_cfg_t *cfg,
+					cli_replay_stats_t *stats);
+
+#endif
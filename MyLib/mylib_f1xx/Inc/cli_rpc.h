@@ -0,0 +1,72 @@
+#ifndef __CLI_RPC_H
+#define __CLI_RPC_H
+
+#include "main.h"
+#include "print_cli.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+/*
+ * Binary request/response mode of the CLI.
+ *
+ * Request : SOF | LEN | SEQ | CMD    | args...          | CRC16 (LSB first)
+ * Response: SOF | LEN | SEQ | STATUS | RTYPE | reply... | CRC16 (LSB first)
+ *
+ * LEN counts the bytes between LEN and the CRC. The CRC16 (poly 0xA001, init 0xFFFF)
+ * covers LEN up to the last payload byte. CMD is the index of the command in the
+ * command table of the console. Every argument is a type byte followed by its value:
+ * CLI_RPC_TYPE_INT32 (4 bytes, little endian) or CLI_RPC_TYPE_STRING (length byte +
+ * characters). SEQ is echoed back so the host can pipeline several requests; they
+ * wait in the RX queue of the console while the current one executes.
+ */
+
+#define CLI_RPC_SOF				0xA5
+#define CLI_RPC_FRAME_MAX		64		// Largest LEN accepted in a request
+#define CLI_RPC_ARGS_MAX		8		// Arguments after the command name
+#define CLI_RPC_REPLY_MAX		96		// Largest reply payload
+#define CLI_RPC_TIMEOUT			50		// Inter-byte gap (ms) that resynchronises the receiver
+
+// Reserved command IDs
+#define CLI_RPC_CMD_LOOKUP		0xFE	// STRING name -> INT32 command ID
+#define CLI_RPC_CMD_EXIT		0xFF	// Return to the text CLI
+
+typedef enum
+{
+	CLI_RPC_TYPE_NONE = 0,
+	CLI_RPC_TYPE_INT32,
+	CLI_RPC_TYPE_STRING
+} cli_rpc_type_t;
+
+typedef enum
+{
+	CLI_RPC_STATUS_OK = 0,
+	CLI_RPC_STATUS_BAD_CRC,
+	CLI_RPC_STATUS_UNKNOWN_CMD,
+	CLI_RPC_STATUS_BAD_ARGS,
+	CLI_RPC_STATUS_ERROR
+} cli_rpc_status_t;
+
+// RPC state of one console
+typedef struct
+{
+	uint8_t active;
+	uint8_t exit_pending;
+	uint8_t len;							// Bytes of frame[] received, 0 while waiting for SOF
+	uint8_t need;
+	uint16_t last_tick;						// Arrival of the previous byte, low half of HAL_GetTick
+	uint8_t frame[CLI_RPC_FRAME_MAX + 3];	// LEN .. CRC
+
+	// Reply being built by the current dispatch
+	cli_rpc_status_t reply_status;
+	uint8_t reply_int_set;
+	int32_t reply_int;
+} cli_rpc_t;
+
+void CLI_RPC_Enter(char **argv, uint8_t arr_token);
+uint8_t CLI_RPC_IsActive(cli_t *cli);
+void CLI_RPC_RxByte(cli_t *cli, uint8_t data, uint16_t tick);
+void CLI_RPC_SetStatus(cli_rpc_status_t status);
+void CLI_RPC_ReplyInt(int32_t value);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __CLI_STREAM_H
+#define __CLI_STREAM_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+#define CLI_STREAM_ARG_SIZE		24		// Longest token including its NUL, longer ones reject the command
+
+// Incremental parser of the raw line mode, fed one byte at a time
+typedef struct
+{
+	uint16_t lo;			// Commands whose name starts with what was received so far: [lo, hi)
+	uint16_t hi;
+	uint8_t argc;			// Completed tokens, the command name included
+	uint8_t arg_len;		// Length of the token being received
+	uint8_t overflow;		// A token did not fit in its slot
+	uint8_t batch;			// A CLI_BATCH_SEPARATOR was seen on this line, its reply is being captured
+	uint8_t batch_count;	// Commands run by the batch so far
+	char arg[CLI_MAX_ARGS][CLI_STREAM_ARG_SIZE];
+} cli_stream_t;
+
+void CLI_Stream_Reset(cli_t *cli);
+void CLI_Stream_Byte(cli_t *cli, uint8_t data);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __CLI_TASK_H
+#define __CLI_TASK_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+#define CLI_TASK_BUDGET_US		500		// Default time given to the running command per main loop pass
+#define CLI_TASK_CANCEL_KEY		0x03	// Ctrl-C
+
+// Resumable command running on one console
+typedef struct
+{
+	cli_task_t task;
+	const cli_command_t *command;		// NULL when no command is running
+	volatile uint8_t cancel;
+	uint32_t budget_us;
+} cli_task_runner_t;
+
+void CLI_Task_Start(cli_t *cli, const cli_command_t *command, char **argv, uint8_t arr_token);
+void CLI_Task_Run(cli_t *cli);
+void CLI_Task_Cancel(cli_t *cli);
+uint8_t CLI_Task_IsBusy(cli_t *cli);
+void CLI_Task_SetBudget(cli_t *cli, uint32_t budget_us);
+
+#endif
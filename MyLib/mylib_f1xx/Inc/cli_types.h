@@ -3,14 +3,83 @@
 
 #include <stdint.h>
 
+#define CLI_MAX_ARGS		10		// Tokens per command, including the name
+#define CLI_TASK_ARGS_MAX	8		// Tokens kept for a resumable command, including the name
+#define CLI_TASK_ARGS_SIZE	48		// Storage for those tokens
+#define CLI_TASK_VARS		4		// Per-invocation variables of a resumable command
+#define CLI_BATCH_SEPARATOR	';'		// Separates the commands of a batch line
+#ifndef CLI_BATCH_REPLY_MAX
+#define CLI_BATCH_REPLY_MAX	384		// Aggregated reply of a batch, per console, must fit in PRINT_CLI_TX_SIZE
+#endif
+
+// Flags of a command table entry
+#define CLI_CMD_NO_WATCH	0x01	// Refused by "watch": switches the console mode or schedules commands itself
+
+typedef enum
+{
+	CLI_TASK_RUNNING = 0,	// Step yielded, call it again in the same time slice
+	CLI_TASK_WAITING,		// Step is waiting for a condition, call it again on the next pass
+	CLI_TASK_DONE			// Command finished
+} cli_task_status_t;
+
+// Per-invocation state of a resumable command
+typedef struct
+{
+	uint16_t pt;						// Protothread resume point, 0 on the first step
+	uint8_t arr_token;
+	char *argv[CLI_TASK_ARGS_MAX];
+	char args[CLI_TASK_ARGS_SIZE];
+	uint32_t var[CLI_TASK_VARS];		// Free for the command (counters, deadlines...)
+} cli_task_t;
+
+typedef struct cli_s cli_t;		// One console, defined in uart.h
+
 typedef void (*CLI_COMMAND_FUN_T)(char **argv, uint8_t arr_token);
+typedef cli_task_status_t (*CLI_STEP_FUN_T)(cli_task_t *task);
+typedef uint16_t (*CLI_SINK_FUN_T)(void *ctx, const uint8_t *data, uint16_t len);
 
 typedef struct
 {
 	char *cmd_name;
 	CLI_COMMAND_FUN_T func;
 	char *help;
+	CLI_STEP_FUN_T step;	// Set instead of func for a command that runs across several main loop passes
+	uint8_t flags;			// CLI_CMD_* flags
 } cli_command_t;
 
+/*
+ * Commands are registered by the module that implements them with CLI_COMMAND or
+ * CLI_COMMAND_STEP, there is no central list to edit. Each entry is a const object in its
+ * own section .cli_cmd.<name>, and the linker script builds the default table in flash,
+ * sorted by name, with no runtime cost and no RAM copy. In the .rodata output section of
+ * the project's *_FLASH.ld:
+ *
+ *   . = ALIGN(4);
+ *   __start_cli_cmd = .;
+ *   KEEP(*(SORT_BY_NAME(.cli_cmd.*)))
+ *   __stop_cli_cmd = .;
+ *
+ * SORT_BY_NAME leaves the table in strcmp order for the binary search, and the terminator
+ * of cli_types.c (.cli_cmd.~) sorts last. Without these lines __start_cli_cmd is undefined
+ * and the link fails. Host/cli_cmd.ld does the same for the Linux build.
+ */
+#define CLI_COMMAND_ENTRY(name, ...) \
+	static const cli_command_t cli_cmd_##name __attribute__((used, section(".cli_cmd." #name), aligned(4))) = \
+	{ .cmd_name = #name, __VA_ARGS__ }
+#define CLI_COMMAND(name, function, text)		CLI_COMMAND_ENTRY(name, .func = function, .help = text)
+#define CLI_COMMAND_STEP(name, function, text)	CLI_COMMAND_ENTRY(name, .step = function, .help = text)
+#define CLI_COMMAND_FLAGS(name, function, text, cmd_flags) \
+	CLI_COMMAND_ENTRY(name, .func = function, .help = text, .flags = cmd_flags)
+
+const cli_command_t* CLI_Commands(void);
+
+/*
+ * Protothread helpers for step functions. Local variables do not survive a yield,
+ * keep the state in task->var.
+ */
+#define CLI_PT_BEGIN(task)				switch ((task)->pt) { case 0:
+#define CLI_PT_YIELD(task)				do { (task)->pt = __LINE__; return CLI_TASK_RUNNING; case __LINE__:; } while (0)
+#define CLI_PT_WAIT_UNTIL(task, cond)	do { (task)->pt = __LINE__; case __LINE__: if (!(cond)) return CLI_TASK_WAITING; } while (0)
+#define CLI_PT_END(task)				} (task)->pt = 0; return CLI_TASK_DONE
 
 #endif
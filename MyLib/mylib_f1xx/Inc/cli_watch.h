@@ -0,0 +1,39 @@
+#ifndef __CLI_WATCH_H
+#define __CLI_WATCH_H
+
+#include "main.h"
+#include "cli_types.h"
+
+#include <stdint.h>
+
+#define CLI_WATCH_MAX			4		// Concurrent watches
+#define CLI_WATCH_ARGS_SIZE		48		// Storage for the arguments of one watch
+#define CLI_WATCH_MIN_PERIOD	10		// Shortest period accepted (ms)
+
+typedef struct
+{
+	const cli_command_t *command;		// Resolved once when the watch is created, NULL when free
+	char *argv[CLI_MAX_ARGS];
+	uint8_t arr_token;
+	char args[CLI_WATCH_ARGS_SIZE];
+	uint32_t period;
+	uint32_t next_tick;
+
+	// Cost of one execution, handler and output included (DWT cycles)
+	uint32_t runs;
+	uint32_t cycles_last;
+	uint32_t cycles_max;
+	uint64_t cycles_total;
+} cli_watch_slot_t;
+
+// Watches of one console
+typedef struct
+{
+	cli_watch_slot_t slot[CLI_WATCH_MAX];
+} cli_watch_t;
+
+void CLI_Watch(char **argv, uint8_t arr_token);
+void CLI_Watch_Process(cli_t *cli, uint32_t current_tick);
+void CLI_Watch_StopAll(cli_t *cli);
+
+#endif
@@ -4,6 +4,7 @@
 #include "main.h"
 #include "uart.h"
 #include "print_cli.h"
+#include "cli_types.h"
 
 #include <stdio.h>
 #include <stdarg.h>
@@ -12,9 +13,15 @@
 
 #define BUFFER_UART 128
 
-extern UART_HandleTypeDef huart1;
-extern uint8_t buff[BUFFER_UART];
+// DWT cycle counter used to measure command cost
+#define CLI_CYCLES_ENABLE()	do { CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; } while (0)
+#define CLI_CYCLES()		(DWT->CYCCNT)
 
+uint16_t CLI_FindPrefix(const cli_t *cli, const char *prefix, uint8_t len, uint16_t *end);
+const cli_command_t* find_commmand(char* cmd);
+void COMMAND_Invoke(const cli_command_t *command, char **argv, uint8_t argc, uint32_t parse, uint32_t lookup);
+void COMMAND_BatchBegin(void);
+void COMMAND_BatchEnd(uint8_t count);
 void COMMAND_EXCUTE(char *buff, uint8_t start);
 
 #endif
@@ -0,0 +1,8 @@
+#ifndef __CRC16_H
+#define __CRC16_H
+
+#include <stdint.h>
+
+uint16_t Crc16_Modbus(const uint8_t *data, uint16_t len);
+
+#endif
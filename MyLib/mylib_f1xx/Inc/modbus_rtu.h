@@ -0,0 +1,76 @@
+#ifndef __MODBUS_RTU_H
+#define __MODBUS_RTU_H
+
+#include "main.h"
+#include "Servo.h"
+
+#include <stdint.h>
+
+#define MODBUS_FRAME_MAX		256		// ADU size allowed by the RTU specification
+#define MODBUS_SERVOS			4		// Servos exposed in the holding registers
+#define MODBUS_PORT_MAX			3		// Modbus UARTs served at the same time
+
+// Function codes
+#define MODBUS_FC_READ_HOLDING		0x03
+#define MODBUS_FC_READ_INPUT		0x04
+#define MODBUS_FC_WRITE_SINGLE		0x06
+#define MODBUS_FC_WRITE_MULTIPLE	0x10
+
+// Exception codes
+#define MODBUS_EX_ILLEGAL_FUNCTION	0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS	0x02
+#define MODBUS_EX_ILLEGAL_VALUE		0x03
+#define MODBUS_EX_DEVICE_FAILURE	0x04	// Applied but not saved, the settings store failed
+
+/*
+ * Register map
+ * Input registers (FC 4):
+ *   0..5    temperature of channel 0..5 (0.1 °C, signed), MODBUS_NO_DATA before the first sample
+ *   6..11   averaged ADC code of channel 0..5
+ *   12..17  alarm state of channel 0..5 (0 normal, 1 high, 2 low)
+ * Holding registers (FC 3, 6, 16):
+ *   0..5    max temperature of channel 0..5 (°C), as setTempMax
+ *   6..11   min temperature of channel 0..5 (°C), as setTempMin
+ *   12..15  servo angle 0..180
+ */
+#define MODBUS_INPUT_TEMP		0
+#define MODBUS_INPUT_ADC		6
+#define MODBUS_INPUT_ALARM		12
+#define MODBUS_INPUT_COUNT		18
+#define MODBUS_HOLD_TEMP_MAX	0
+#define MODBUS_HOLD_TEMP_MIN	6
+#define MODBUS_HOLD_SERVO		12
+#define MODBUS_HOLD_COUNT		16
+#define MODBUS_NO_DATA			0x8000
+
+typedef struct
+{
+	uint32_t frames;			// Frames addressed to this slave and answered
+	uint32_t crc_errors;
+	uint32_t exceptions;
+	uint32_t overruns;			// Bytes received while the previous frame was not handled yet
+	uint32_t ignored;			// Frames for other slaves or too short
+	uint32_t tx_errors;			// Replies the UART refused, not counted in frames
+} modbus_stats_t;
+
+typedef struct
+{
+	UART_HandleTypeDef *huart;
+	TIM_HandleTypeDef *htim;			// Counts in µs, its update interrupt marks the end of a frame
+	uint8_t address;
+	uint8_t data_rx;
+	uint8_t rx[MODBUS_FRAME_MAX];
+	volatile uint16_t rx_len;
+	volatile uint8_t frame_ready;		// Silence of 3.5 characters seen, rx holds one frame
+	uint8_t tx[MODBUS_FRAME_MAX];
+	Servo *servo[MODBUS_SERVOS];
+	modbus_stats_t stats;
+} modbus_t;
+
+void Modbus_Init(modbus_t *mb, UART_HandleTypeDef *huart, TIM_HandleTypeDef *htim, uint8_t address);
+void Modbus_AttachServo(modbus_t *mb, uint8_t index, Servo *sv);
+uint8_t Modbus_HandleRx(UART_HandleTypeDef *huart);
+void Modbus_TimerElapsed(TIM_HandleTypeDef *htim);
+void Modbus_Process(modbus_t *mb);
+
+#endif
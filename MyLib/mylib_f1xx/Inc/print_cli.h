@@ -9,9 +9,52 @@
 
 #define BUFFER_UART 128
 
-extern UART_HandleTypeDef huart1;
+// Size of the TX ring drained by the UART interrupt, per console (must be a power of two)
+#ifndef PRINT_CLI_TX_SIZE
+#define PRINT_CLI_TX_SIZE	512
+#endif
+
+// Set to 1 to drain the TX ring with HAL_UART_Transmit_DMA instead of HAL_UART_Transmit_IT
+#ifndef PRINT_CLI_USE_DMA
+#define PRINT_CLI_USE_DMA	0
+#endif
+
+// TX statistics
+typedef struct
+{
+	uint32_t bytes_queued;		// Bytes accepted into the TX ring
+	uint32_t bytes_sent;		// Bytes handed over to the UART
+	uint32_t truncated;			// Messages cut to BUFFER_UART while formatting
+	uint32_t overflow;			// Messages dropped because the TX ring was full
+	uint32_t dropped_bytes;		// Bytes lost by those dropped messages
+} print_cli_stats_t;
+
+// TX side of one console
+typedef struct
+{
+	UART_HandleTypeDef *huart;
+	uint8_t ring[PRINT_CLI_TX_SIZE];
+	volatile uint16_t head;		// Written by PRINT_CLI (main loop)
+	volatile uint16_t tail;		// Advanced by the TX complete interrupt
+	volatile uint16_t len;		// Bytes of the transfer in flight, 0 when idle
+	print_cli_stats_t stats;
+
+	// Optional redirection of the output into a caller buffer (RPC replies, batches)
+	uint8_t *capture_buf;
+	uint16_t capture_size;
+	uint16_t capture_len;
+} print_cli_tx_t;
 
 void PRINT_CLI(char *str, ...);
+uint16_t PRINT_CLI_Write(const uint8_t *data, uint16_t len);
+void PRINT_CLI_CaptureBegin(uint8_t *buf, uint16_t size);
+uint16_t PRINT_CLI_CaptureEnd(void);
 
-#endif
+void PRINT_CLI_TxInit(print_cli_tx_t *tx, UART_HandleTypeDef *huart);
+uint16_t PRINT_CLI_TxWrite(void *ctx, const uint8_t *data, uint16_t len);
+uint16_t PRINT_CLI_TxFree(print_cli_tx_t *tx);
+void PRINT_CLI_Flush(print_cli_tx_t *tx);
+void PRINT_CLI_TxComplete(print_cli_tx_t *tx);
+void PRINT_CLI_GetStats(print_cli_tx_t *tx, print_cli_stats_t *stats);
 
+#endif
@@ -0,0 +1,25 @@
+#ifndef SOFT_TIMER_H
+#define SOFT_TIMER_H
+
+#include "stm32f1xx_hal.h"
+
+typedef struct SoftTimer SoftTimer_t;
+
+// One-shot software timer, kept in a list sorted by deadline
+struct SoftTimer {
+    SoftTimer_t* next;           // Next armed timer (later deadline)
+    uint32_t deadline;           // Tick at which the callback runs
+    uint8_t active;              // Timer is in the list
+    void (*callback)(SoftTimer_t* timer, uint32_t current_tick);
+    void* context;               // Owner of the timer, free for the callback
+};
+
+// Function prototypes
+void SoftTimer_Init(SoftTimer_t* timer, void (*callback)(SoftTimer_t*, uint32_t), void* context);
+void SoftTimer_Start(SoftTimer_t* timer, uint32_t deadline);
+void SoftTimer_Stop(SoftTimer_t* timer);
+void SoftTimer_Process(uint32_t current_tick);
+uint8_t SoftTimer_ProcessOne(uint32_t current_tick);
+uint8_t SoftTimer_Next(uint32_t* deadline);
+
+#endif // SOFT_TIMER_H
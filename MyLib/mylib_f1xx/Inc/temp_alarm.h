@@ -0,0 +1,54 @@
+#ifndef __TEMP_ALARM_H
+#define __TEMP_ALARM_H
+
+#include "main.h"
+#include "temperature.h"
+
+#include <stdint.h>
+
+#define TEMP_ALARM_HYST			20		// A limit clears this far inside it (0.1 °C)
+#define TEMP_ALARM_DEBOUNCE		3		// Consecutive samples needed to change state
+#define TEMP_ALARM_QUEUE		16		// Pending events (power of two)
+#define TEMP_LIMIT_LOW			-100	// Range of the max/min limits (°C)
+#define TEMP_LIMIT_HIGH			100
+
+typedef enum
+{
+	TEMP_ALARM_NORMAL = 0,
+	TEMP_ALARM_HIGH,
+	TEMP_ALARM_LOW
+} temp_alarm_state_t;
+
+typedef enum
+{
+	TEMP_ALARM_EVT_HIGH_SET = 0,
+	TEMP_ALARM_EVT_HIGH_CLEAR,
+	TEMP_ALARM_EVT_LOW_SET,
+	TEMP_ALARM_EVT_LOW_CLEAR
+} temp_alarm_event_id_t;
+
+typedef struct
+{
+	uint8_t channel;
+	uint8_t event;			// temp_alarm_event_id_t
+	int16_t value;			// Sample that completed the debounce (0.1 °C)
+	uint32_t tick;
+} temp_alarm_event_t;
+
+typedef struct
+{
+	uint8_t state;			// temp_alarm_state_t
+	uint8_t pending;		// Samples in a row pointing to another state
+	uint32_t since;			// Tick the current alarm was raised
+	uint32_t count;			// Alarms raised
+	uint32_t alarm_ms;		// Time spent in alarm, the current one excluded
+} temp_alarm_channel_t;
+
+void TempAlarm_Update(uint8_t channel, int16_t value, uint32_t tick);
+uint8_t TempAlarm_Pop(temp_alarm_event_t *event);
+const temp_alarm_channel_t* TempAlarm_Get(uint8_t channel);
+uint32_t TempAlarm_Dropped(void);
+uint8_t TempAlarm_CheckLimit(uint8_t channel, uint8_t is_min, int32_t value, const int16_t *other);
+void tempAlarm(char **argv, uint8_t arr_token);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __TEMPERATURE_H
+#define __TEMPERATURE_H
+
+#include "main.h"
+
+#include <stdint.h>
+
+#define TEMP_CHANNELS			6		// ADC scan ranks 1..6, one NTC each
+#define TEMP_SCANS				8		// Scans kept in the DMA buffer and averaged per update
+#define TEMP_PERIOD				10		// Cache update period (ms)
+#define TEMP_FILTER_SHIFT		3		// IIR weight of a new sample: 1 / 2^shift
+
+// NTC 10k B3950 to ground, 10k pull-up to VDDA, 12-bit ADC
+#define TEMP_LUT_SHIFT			7		// ADC codes between two table points: 2^shift
+#define TEMP_MIN				(-550)	// Clamp of the table (0.1 °C)
+#define TEMP_MAX				1500
+
+typedef struct
+{
+	int16_t value;			// Filtered temperature (0.1 °C)
+	uint16_t raw;			// Last averaged ADC code
+	uint32_t tick;			// Tick of the last update
+	uint8_t valid;
+} temp_cache_t;
+
+#ifdef HAL_ADC_MODULE_ENABLED		// The readers below also build without the ADC driver
+HAL_StatusTypeDef Temperature_Init(ADC_HandleTypeDef *hadc);
+#endif
+void Temperature_Process(uint32_t tick);
+uint8_t Temperature_Get(uint8_t channel, int16_t *value, uint32_t *age);
+uint16_t Temperature_GetRaw(uint8_t channel);
+int16_t Temperature_FromAdc(uint16_t code);
+
+#endif
@@ -2,11 +2,13 @@
 #define __TEMPERATURE_CLI_H
 
 #include "main.h"
+#include "cli_types.h"
 
 #include <stdlib.h>
 
 void getTemp(char **argv, uint8_t arr_token);
 void setTempMax(char **argv, uint8_t arr_token);
 void setTempMin(char **argv, uint8_t arr_token);
+cli_task_status_t sampleTemp(cli_task_t *task);
 
 #endif
@@ -6,17 +6,77 @@
 #include "main.h"
 #include "print_cli.h"
 #include "command_excute.h"
+#include "cli_types.h"
+#include "cli_rpc.h"
+#include "cli_watch.h"
+#include "cli_task.h"
+#include "cli_edit.h"
+#include "cli_perf.h"
+#include "cli_replay.h"
+#include "cli_stream.h"
 
 #define BUFFER_UART 128
 
-extern UART_HandleTypeDef huart1;
+// Per console: the queue costs 3 bytes of RAM per entry (byte and arrival tick)
+#ifndef UART_RX_QUEUE
+#define UART_RX_QUEUE	64		// Bytes buffered between the RX interrupt and CLI_Handle (power of two)
+#endif
+#define UART_PORT_MAX	3		// USART1..USART3
+
+// One console: its UART, RX queue, TX sink, command table and the state of every CLI mode
+struct cli_s
+{
+	UART_HandleTypeDef *huart;
+	const cli_command_t *commands;
+	uint16_t command_count;
+	uint8_t commands_sorted;		// Table in strcmp order, searched by binary search
+
+	// RX: the interrupt only queues bytes, CLI_Handle parses commands and frames
+	uint8_t data_rx;
+	uint8_t rx_queue[UART_RX_QUEUE];
+	uint16_t rx_tick[UART_RX_QUEUE];	// Low half of HAL_GetTick when each byte arrived
+	volatile uint16_t rx_head;
+	volatile uint16_t rx_tail;
+	uint32_t rx_dropped;
+	uint16_t rx_peak;				// Deepest the queue has been
+	uint8_t cancel;					// Ctrl-C dequeued, acted on once the queue is drained
+	cli_stream_t stream;			// Raw line mode
+	uint8_t line[BUFFER_UART];		// Line being edited in interactive mode
+	uint8_t line_len;
+	uint8_t batch_reply[CLI_BATCH_REPLY_MAX];	// Output of the batch being run, sent as one reply
+	uint8_t *volatile record_buf;	// Copy of the raw RX stream for CLI_Replay_Run, NULL when off
+	uint16_t record_size;
+	volatile uint16_t record_len;
 
-extern uint8_t data_rx;
-extern uint8_t buff[BUFFER_UART];
-extern uint8_t index_uart;
-extern uint8_t Flag_UART;
+	// TX: everything printed goes through sink, the UART TX ring by default
+	print_cli_tx_t tx;
+	CLI_SINK_FUN_T sink;
+	void *sink_ctx;
+
+	cli_rpc_t rpc;
+	cli_watch_t watch;
+	cli_task_runner_t task;
+	cli_edit_t edit;
+#if CLI_PERF_ENABLE
+	cli_perf_t perf;
+#endif
+};
+
+extern cli_t *cli_current;		// Console being serviced, target of PRINT_CLI
+
+// Receive interrupt of a UART that has no console, returns 1 if it handled the UART
+typedef uint8_t (*UART_RX_HOOK_T)(UART_HandleTypeDef *huart);
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+
+void CLI_Init(cli_t *cli, UART_HandleTypeDef *huart, const cli_command_t *commands);
+void CLI_SetSink(cli_t *cli, CLI_SINK_FUN_T sink, void *ctx);
+void CLI_RxByte(cli_t *cli, uint8_t data);
+void CLI_Handle(cli_t *cli);
+cli_t* CLI_FromUart(UART_HandleTypeDef *huart);
+
+void UART_SetRxHook(UART_RX_HOOK_T hook);
 void UART_Init(UART_HandleTypeDef *huart);
 void UART_HANDLE();
 
@@ -11,6 +11,7 @@ void SERVO_WRITE(Servo *sv, uint8_t ANGLE)
     // ANGLE từ 0 → 180
     // Tương ứng với độ rộng xung từ khoảng 544 → 2400 (micro giây)
     uint16_t CCR = map(ANGLE, 0, 180, 544, 2400);
+    sv->angle = ANGLE;
 
     switch (sv->CHANNEL)
     {
@@ -32,9 +33,16 @@ void SERVO_WRITE(Servo *sv, uint8_t ANGLE)
     }
 }
 
+uint8_t SERVO_READ(Servo *sv)
+{
+    // Góc đặt lần cuối bằng SERVO_WRITE
+    return sv->angle;
+}
+
 void SERVO_Init(Servo *sv, TIM_HandleTypeDef *htim, uint16_t CHANNEL)
 {
     sv->htim = htim;
     sv->CHANNEL = CHANNEL;
+    sv->angle = 0;
     HAL_TIM_PWM_Start(htim, CHANNEL);  // Khởi động PWM ở kênh tương ứng
 }
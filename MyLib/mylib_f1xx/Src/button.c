@@ -1,5 +1,23 @@
 #include "button.h"
 
+static ButtonEventRecord_t button_queue[BTN_QUEUE_SIZE];
+static volatile uint16_t button_queue_head;   // Written by the producer only
+static volatile uint16_t button_queue_tail;   // Written by the consumer only
+static uint32_t button_queue_dropped;
+
+static void Button_Deadline(SoftTimer_t* timer, uint32_t current_tick);
+
+/**
+ * @brief Default pin read
+ * @param p_button: Pointer to the Button structure
+ * @return uint8_t: Raw pin level
+ */
+static uint8_t Button_ReadPin(Button_t* p_button) {
+    return HAL_GPIO_ReadPin(p_button->GPIOx, p_button->GPIO_Pin);
+}
+
+static uint8_t (*button_read)(Button_t* p_button) = Button_ReadPin;
+
 /**
  * @brief Initialize the button configuration
  * @param p_button: Pointer to the Button structure
@@ -36,6 +54,22 @@ void Button_Init(Button_t* p_button, GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, But
     p_button->press_count = 0;
     p_button->last_press_time = 0;
 
+    // Default thresholds, no deadline armed
+    p_button->timing.short_ms = BTN_SHORT_THRESHOLD;
+    p_button->timing.long_ms = BTN_LONG_THRESHOLD;
+    p_button->timing.very_long_ms = BTN_VERY_LONG_THRESHOLD;
+    p_button->timing.double_ms = BTN_DOUBLE_PRESS_INTERVAL;
+    p_button->timing.hold_ms = BTN_HOLD_INTERVAL;
+    p_button->timing.debounce_ms = BTN_DEBOUNCE_TIME;
+    SoftTimer_Init(&p_button->timer, Button_Deadline, p_button);
+    p_button->edge_debounce = 0;
+    p_button->repeat_profile = NULL;
+    p_button->repeat = 0;
+
+    // Callback mode until Button_EnableQueue
+    p_button->id = 0;
+    p_button->queue_events = 0;
+
     // Reset all callbacks to NULL
     p_button->pressed_callback = NULL;
     p_button->released_callback = NULL;
@@ -82,6 +116,212 @@ void Button_SetCallback(Button_t* p_button, ButtonEvent event, void (*callback)(
     }
 }
 
+/**
+ * @brief Switch a button to event-queue mode
+ * @note Selected events are pushed to the queue instead of calling the callbacks, the
+ *       others are dropped. A mask of 0 goes back to callback mode.
+ * @param p_button: Pointer to the Button structure
+ * @param id: Identifier stored in each record
+ * @param events: Mask of BUTTON_EVENT_MASK(event) values to queue
+ */
+void Button_EnableQueue(Button_t* p_button, uint8_t id, uint8_t events) {
+    if (p_button == NULL) return;
+
+    p_button->id = id;
+    p_button->queue_events = events;
+}
+
+/**
+ * @brief Take the oldest record from the event queue
+ * @note Single consumer: call from one context only (usually the main loop)
+ * @param record: Destination for the record
+ * @return uint8_t: 1 if a record was read, 0 if the queue is empty
+ */
+uint8_t Button_PopEvent(ButtonEventRecord_t* record) {
+    uint16_t tail = button_queue_tail;
+
+    if (record == NULL || tail == button_queue_head) return 0;
+
+    __DMB();
+    *record = button_queue[tail & (BTN_QUEUE_SIZE - 1)];
+    __DMB();
+    button_queue_tail = tail + 1;
+    return 1;
+}
+
+/**
+ * @brief Number of records lost because the queue was full
+ * @return uint32_t: Dropped records since reset
+ */
+uint32_t Button_QueueDropped(void) {
+    return button_queue_dropped;
+}
+
+/**
+ * @brief Check if an event of a button has a consumer (callback or queue)
+ * @param p_button: Pointer to the Button structure
+ * @param event: Button event type
+ * @return uint8_t: 1 if the event is consumed, 0 otherwise
+ */
+static uint8_t Button_Wants(Button_t* p_button, ButtonEvent event) {
+    if (p_button->queue_events) {
+        return (p_button->queue_events & BUTTON_EVENT_MASK(event)) != 0;
+    }
+    return event == BUTTON_EVENT_HOLD && p_button->hold_callback != NULL;
+}
+
+/**
+ * @brief Deliver an event: push a record in queue mode, call the callback otherwise
+ * @note Single producer: every button in queue mode must be handled from the same context
+ *       (main loop or one interrupt). The record is written before the head moves.
+ * @param p_button: Pointer to the Button structure
+ * @param event: Button event type
+ * @param current_tick: Timestamp of the event
+ */
+static void Button_Emit(Button_t* p_button, ButtonEvent event, uint32_t current_tick) {
+    if (p_button->queue_events) {
+        if (!(p_button->queue_events & BUTTON_EVENT_MASK(event))) return;
+
+        uint16_t head = button_queue_head;
+        if ((uint16_t)(head - button_queue_tail) >= BTN_QUEUE_SIZE) {
+            button_queue_dropped++;
+            return;
+        }
+
+        ButtonEventRecord_t* record = &button_queue[head & (BTN_QUEUE_SIZE - 1)];
+        record->id = p_button->id;
+        record->event = event;
+        record->repeat = (event == BUTTON_EVENT_HOLD) ? p_button->repeat : 0;
+        record->tick = current_tick;
+        __DMB();
+        button_queue_head = head + 1;
+        return;
+    }
+
+    void (*callback)(void) = NULL;
+    switch (event) {
+        case BUTTON_EVENT_PRESSED:
+            callback = p_button->pressed_callback;
+            break;
+        case BUTTON_EVENT_RELEASED:
+            callback = p_button->released_callback;
+            break;
+        case BUTTON_EVENT_SHORT_PRESS:
+            callback = p_button->short_press_callback;
+            break;
+        case BUTTON_EVENT_LONG_PRESS:
+            callback = p_button->long_press_callback;
+            break;
+        case BUTTON_EVENT_VERY_LONG_PRESS:
+            callback = p_button->very_long_press_callback;
+            break;
+        case BUTTON_EVENT_DOUBLE_PRESS:
+            callback = p_button->double_press_callback;
+            break;
+        case BUTTON_EVENT_HOLD:
+            callback = p_button->hold_callback;
+            break;
+        default:
+            break;
+    }
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+/**
+ * @brief Replace the pin read of every Button_t
+ * @note For simulation (see button_sim.h): levels come from a trace instead of the GPIO.
+ *       ButtonBank, ButtonMatrix and ButtonDma read the port registers and are not affected.
+ * @param read: Function returning the raw level of a button, NULL restores HAL_GPIO_ReadPin
+ */
+void Button_SetReadHook(uint8_t (*read)(Button_t* p_button)) {
+    button_read = (read != NULL) ? read : Button_ReadPin;
+}
+
+/**
+ * @brief Use an acceleration profile for the hold events of a button
+ * @note The profile is kept by reference. NULL goes back to a fixed timing.hold_ms.
+ *       A profile with a 0 ms interval is rejected: the hold deadline would never advance.
+ * @param p_button: Pointer to the Button structure
+ * @param profile: Intervals between hold events
+ */
+void Button_SetRepeatProfile(Button_t* p_button, const ButtonRepeatProfile_t* profile) {
+    if (p_button == NULL) return;
+
+    if (profile != NULL) {
+        if (profile->interval == NULL || profile->length == 0) return;
+        for (uint8_t i = 0; i < profile->length; i++) {
+            if (profile->interval[i] == 0) return;
+        }
+    }
+    p_button->repeat_profile = profile;
+}
+
+/**
+ * @brief Number of hold events since the button was pressed
+ * @note Call from the hold callback: 1 on the first hold event
+ * @param p_button: Pointer to the Button structure
+ * @return uint16_t: Repeat count
+ */
+uint16_t Button_GetRepeat(Button_t* p_button) {
+    if (p_button == NULL) return 0;
+
+    return p_button->repeat;
+}
+
+/**
+ * @brief Fill a repeat table: initial delay, then a linear ramp down to a floor
+ * @note Computed once (e.g. at init), the driver only indexes the table afterwards. The last
+ *       entry written is always floor_ms, a table too small for the ramp jumps to it early.
+ *       Intervals below 1 ms are raised to 1 ms.
+ * @param table: Destination, at least steps + 2 entries for the whole ramp
+ * @param size: Capacity of table
+ * @param initial_ms: Delay before the first hold event
+ * @param start_ms: Interval after the first hold event
+ * @param floor_ms: Fastest interval, kept for every later repeat
+ * @param steps: Repeats taken to go from start_ms to floor_ms, 0 to use floor_ms at once
+ * @return uint8_t: Entries written, for ButtonRepeatProfile_t.length
+ */
+uint8_t Button_BuildRepeatProfile(uint16_t* table, uint8_t size, uint16_t initial_ms,
+                                  uint16_t start_ms, uint16_t floor_ms, uint8_t steps) {
+    if (table == NULL || size == 0) return 0;
+
+    if (initial_ms == 0) initial_ms = 1;
+    if (floor_ms == 0) floor_ms = 1;
+    if (start_ms < floor_ms) start_ms = floor_ms;
+
+    uint8_t length = 0;
+    table[length++] = initial_ms;
+
+    for (uint8_t i = 1; i <= steps && length < size; i++) {
+        int32_t interval = start_ms - ((int32_t)(start_ms - floor_ms) * (i - 1)) / steps;
+        table[length++] = (uint16_t)interval;
+    }
+    if (length < size) {
+        table[length++] = floor_ms;
+    } else if (length > 1) {
+        table[length - 1] = floor_ms;
+    }
+    return length;
+}
+
+/**
+ * @brief Replace the timing thresholds of a button
+ * @note Takes effect from the next press. hold_ms is raised to 1 ms: a 0 ms repeat would
+ *       re-arm the hold deadline at the current tick forever.
+ * @param p_button: Pointer to the Button structure
+ * @param timing: New thresholds
+ */
+void Button_SetTiming(Button_t* p_button, const ButtonTiming_t* timing) {
+    if (p_button == NULL || timing == NULL) return;
+
+    p_button->timing = *timing;
+    if (p_button->timing.hold_ms == 0) {
+        p_button->timing.hold_ms = 1;
+    }
+}
+
 /**
  * @brief Perform debouncing logic for the button
  * @param p_button: Pointer to the Button structure
@@ -94,7 +334,7 @@ uint8_t Button_Debounce(Button_t* p_button, uint32_t current_tick) {
     uint8_t state_changed = 0;
 
     // Read current raw pin state
-    uint8_t gpio_state = HAL_GPIO_ReadPin(p_button->GPIOx, p_button->GPIO_Pin);
+    uint8_t gpio_state = button_read(p_button);
 
     // If state differs from filtered value, start or continue debounce
     if (gpio_state != p_button->btn_filter) {
@@ -102,7 +342,7 @@ uint8_t Button_Debounce(Button_t* p_button, uint32_t current_tick) {
             p_button->is_deboucing = 1;
             p_button->time_debounce = current_tick;
         }
-        else if ((current_tick - p_button->time_debounce) >= BTN_DEBOUNCE_TIME) {
+        else if ((current_tick - p_button->time_debounce) >= p_button->timing.debounce_ms) {
             // State confirmed stable after debounce delay
             p_button->btn_last = p_button->btn_current;
             p_button->btn_current = gpio_state;
@@ -155,6 +395,9 @@ uint8_t Button_GetEvent(Button_t* p_button, ButtonEvent event) {
 
 /**
  * @brief Handle and evaluate all button events
+ * @note Self-sufficient: the long, very long and hold deadline of the button is checked here
+ *       with one compare. SoftTimer_Process is only needed for buttons driven by
+ *       Button_Edge or a ButtonBank, which are not polled. Calling both is harmless.
  * @param p_button: Pointer to the Button structure
  * @param current_tick: Current system tick
  */
@@ -162,94 +405,276 @@ void Button_Handle(Button_t* p_button, uint32_t current_tick) {
     if (p_button == NULL) return;
 
     // Check for debounced state change
-    uint8_t state_changed = Button_Debounce(p_button, current_tick);
+    Button_Update(p_button, Button_Debounce(p_button, current_tick), current_tick);
 
-    if (state_changed) {
-        uint8_t is_pressed = Button_IsPressed(p_button);
+    if (p_button->timer.active && (int32_t)(current_tick - p_button->timer.deadline) >= 0) {
+        SoftTimer_Stop(&p_button->timer);
+        Button_Deadline(&p_button->timer, current_tick);
+    }
+}
 
-        if (is_pressed && !p_button->is_pressed) {
-            // Button just pressed
-            p_button->is_pressed = 1;
-            p_button->press_time = current_tick;
-            p_button->is_long_pressed = 0;
-            p_button->is_very_long_pressed = 0;
+/**
+ * @brief Tick of the next hold event of a pressed button
+ * @note One table lookup: the first event comes interval[0] after the press, each next one
+ *       interval[repeat] after the previous, the last entry repeats
+ * @param p_button: Pointer to the Button structure
+ * @return uint32_t: Deadline of the next hold event
+ */
+static uint32_t Button_NextHold(Button_t* p_button) {
+    const ButtonRepeatProfile_t* profile = p_button->repeat_profile;
+    uint32_t from = p_button->is_holding ? p_button->last_tick : p_button->press_time;
 
-            if (p_button->pressed_callback != NULL) {
-                p_button->pressed_callback();
-            }
+    if (profile == NULL) {
+        return from + p_button->timing.hold_ms;
+    }
+    uint16_t i = (p_button->repeat < profile->length) ? p_button->repeat : profile->length - 1;
+    return from + profile->interval[i];
+}
 
-            // Check for double press
-            if (current_tick - p_button->last_press_time < BTN_DOUBLE_PRESS_INTERVAL) {
-                p_button->press_count++;
-
-                if (p_button->press_count >= 2) {
-                    if (p_button->double_press_callback != NULL) {
-                        p_button->double_press_callback();
-                    }
-                    p_button->press_count = 0;
-                }
-            } else {
-                p_button->press_count = 1;
-            }
+/**
+ * @brief Arm the timer for the next long/very long/hold deadline of a pressed button
+ * @note Stops the timer when the button is released or nothing is left to detect
+ * @param p_button: Pointer to the Button structure
+ */
+static void Button_Schedule(Button_t* p_button) {
+    ButtonTiming_t* timing = &p_button->timing;
+    uint32_t next = UINT32_MAX;                 // Offset from press_time
+
+    if (!p_button->is_pressed) {
+        SoftTimer_Stop(&p_button->timer);
+        return;
+    }
 
-            p_button->last_press_time = current_tick;
+    if (!p_button->is_very_long_pressed) {
+        next = timing->very_long_ms;
+        if (!p_button->is_long_pressed && timing->long_ms < next) {
+            next = timing->long_ms;
         }
-        else if (!is_pressed && p_button->is_pressed) {
-            // Button just released
-            p_button->is_pressed = 0;
-            p_button->is_holding = 0;
-            p_button->release_time = current_tick;
-            uint32_t press_duration = current_tick - p_button->press_time;
-
-            if (p_button->released_callback != NULL) {
-                p_button->released_callback();
-            }
+    }
+    if (Button_Wants(p_button, BUTTON_EVENT_HOLD)) {
+        uint32_t hold = Button_NextHold(p_button) - p_button->press_time;
+        if (hold < next) {
+            next = hold;
+        }
+    }
 
-            // Handle short press
-            if (!p_button->is_long_pressed && !p_button->is_very_long_pressed &&
-                press_duration < BTN_SHORT_THRESHOLD) {
-                if (p_button->short_press_callback != NULL) {
-                    p_button->short_press_callback();
-                }
-            }
+    if (next == UINT32_MAX) {
+        SoftTimer_Stop(&p_button->timer);
+    } else {
+        SoftTimer_Start(&p_button->timer, p_button->press_time + next);
+    }
+}
+
+/**
+ * @brief Fire the long, very long and hold events that are due
+ * @param p_button: Pointer to the Button structure
+ * @param current_tick: Current system tick
+ */
+static void Button_CheckDeadlines(Button_t* p_button, uint32_t current_tick) {
+    uint32_t press_duration = current_tick - p_button->press_time;
+
+    // Very long press
+    if (!p_button->is_very_long_pressed && press_duration >= p_button->timing.very_long_ms) {
+        p_button->is_very_long_pressed = 1;
+
+        Button_Emit(p_button, BUTTON_EVENT_VERY_LONG_PRESS, current_tick);
+    }
+    // Long press
+    else if (!p_button->is_long_pressed && press_duration >= p_button->timing.long_ms) {
+        p_button->is_long_pressed = 1;
+
+        Button_Emit(p_button, BUTTON_EVENT_LONG_PRESS, current_tick);
+    }
+
+    // Hold callback (repeated)
+    if (Button_Wants(p_button, BUTTON_EVENT_HOLD)) {
+        if ((int32_t)(current_tick - Button_NextHold(p_button)) >= 0) {
+            p_button->is_holding = 1;
+            p_button->last_tick = current_tick;
+            p_button->repeat++;
+            Button_Emit(p_button, BUTTON_EVENT_HOLD, current_tick);
         }
     }
+}
 
-    // Check for long, very long press, and hold (checked continuously)
-    if (p_button->is_pressed) {
-        uint32_t press_duration = current_tick - p_button->press_time;
+/**
+ * @brief Timer callback: end an edge debounce or handle a press deadline
+ * @param timer: Timer of the button
+ * @param current_tick: Current system tick
+ */
+static void Button_Deadline(SoftTimer_t* timer, uint32_t current_tick) {
+    Button_t* p_button = (Button_t*)timer->context;
 
-        // Very long press
-        if (!p_button->is_very_long_pressed && press_duration >= BTN_VERY_LONG_THRESHOLD) {
-            p_button->is_very_long_pressed = 1;
+    if (p_button->edge_debounce) {
+        p_button->edge_debounce = 0;
+        p_button->is_deboucing = 0;
 
-            if (p_button->very_long_press_callback != NULL) {
-                p_button->very_long_press_callback();
-            }
+        uint8_t gpio_state = button_read(p_button);
+        if (gpio_state != p_button->btn_filter) {
+            p_button->btn_last = p_button->btn_current;
+            p_button->btn_current = gpio_state;
+            p_button->btn_filter = gpio_state;
+            Button_Update(p_button, 1, current_tick);
+            return;
         }
-        // Long press
-        else if (!p_button->is_long_pressed && press_duration >= BTN_LONG_THRESHOLD) {
-            p_button->is_long_pressed = 1;
+        // Bounced back: only the press deadlines (if any) remain
+    } else if (p_button->is_pressed) {
+        Button_CheckDeadlines(p_button, current_tick);
+    }
+    Button_Schedule(p_button);
+}
+
+/**
+ * @brief Start an edge-triggered debounce
+ * @note Alternative to polling Button_Handle: call from HAL_GPIO_EXTI_Callback for the pin of
+ *       the button. The pin is read once, debounce_ms after the last edge.
+ * @param p_button: Pointer to the Button structure
+ * @param current_tick: Current system tick
+ */
+void Button_Edge(Button_t* p_button, uint32_t current_tick) {
+    if (p_button == NULL) return;
+
+    p_button->edge_debounce = 1;
+    p_button->is_deboucing = 1;
+    p_button->time_debounce = current_tick;
+    SoftTimer_Start(&p_button->timer, current_tick + p_button->timing.debounce_ms);
+}
+
+/**
+ * @brief Evaluate press/release/double events from an already debounced state
+ * @note Long, very long and hold are not polled: the next of their deadlines is armed on the
+ *       button timer and runs from Button_Handle or SoftTimer_Process, whichever comes first.
+ * @param p_button: Pointer to the Button structure
+ * @param state_changed: 1 if btn_current changed since the last call
+ * @param current_tick: Current system tick
+ */
+void Button_Update(Button_t* p_button, uint8_t state_changed, uint32_t current_tick) {
+    if (!state_changed) return;
 
-            if (p_button->long_press_callback != NULL) {
-                p_button->long_press_callback();
+    uint8_t is_pressed = Button_IsPressed(p_button);
+
+    if (is_pressed && !p_button->is_pressed) {
+        // Button just pressed
+        p_button->is_pressed = 1;
+        p_button->press_time = current_tick;
+        p_button->is_long_pressed = 0;
+        p_button->is_very_long_pressed = 0;
+        p_button->repeat = 0;
+
+        Button_Emit(p_button, BUTTON_EVENT_PRESSED, current_tick);
+
+        // Check for double press
+        if (current_tick - p_button->last_press_time < p_button->timing.double_ms) {
+            p_button->press_count++;
+
+            if (p_button->press_count >= 2) {
+                Button_Emit(p_button, BUTTON_EVENT_DOUBLE_PRESS, current_tick);
+                p_button->press_count = 0;
             }
+        } else {
+            p_button->press_count = 1;
         }
 
-        // Hold callback (repeated)
-        if (p_button->hold_callback != NULL) {
-            if (!p_button->is_holding) {
-                if (press_duration >= BTN_HOLD_INTERVAL) {
-                    p_button->is_holding = 1;
-                    p_button->last_tick = current_tick;
-                    p_button->hold_callback();
-                }
-            } else {
-                if (current_tick - p_button->last_tick >= BTN_HOLD_INTERVAL) {
-                    p_button->last_tick = current_tick;
-                    p_button->hold_callback();
-                }
-            }
+        p_button->last_press_time = current_tick;
+        Button_Schedule(p_button);
+    }
+    else if (!is_pressed && p_button->is_pressed) {
+        // Button just released
+        p_button->is_pressed = 0;
+        p_button->is_holding = 0;
+        p_button->release_time = current_tick;
+        uint32_t press_duration = current_tick - p_button->press_time;
+        Button_Schedule(p_button);
+
+        Button_Emit(p_button, BUTTON_EVENT_RELEASED, current_tick);
+
+        // Handle short press
+        if (!p_button->is_long_pressed && !p_button->is_very_long_pressed &&
+            press_duration < p_button->timing.short_ms) {
+            Button_Emit(p_button, BUTTON_EVENT_SHORT_PRESS, current_tick);
+        }
+    }
+}
+
+static volatile uint8_t button_wake;        // Edge seen since the last Button_Sleep
+static volatile uint8_t button_sleeping;
+static ButtonPowerStats_t button_power;
+
+/**
+ * @brief Check if a button needs no more polling until its next edge
+ * @note Released, not debouncing, no timer armed. A pressed button still waits for deadlines.
+ * @param p_button: Pointer to the Button structure
+ * @return uint8_t: 1 if idle, 0 otherwise
+ */
+uint8_t Button_IsIdle(Button_t* p_button) {
+    if (p_button == NULL) return 1;
+
+    return !p_button->is_pressed && !p_button->is_deboucing && !Button_IsPressed(p_button) &&
+           !p_button->timer.active;
+}
+
+/**
+ * @brief Wake the button driver on an edge
+ * @note Call from HAL_GPIO_EXTI_Callback, the pins must be configured as EXTI on both edges
+ * @param GPIO_Pin: Pin that triggered the interrupt
+ */
+void Button_EXTI_Callback(uint16_t GPIO_Pin) {
+    (void)GPIO_Pin;
+
+    button_wake = 1;
+    if (button_sleeping) {
+        button_power.wakeups++;
+        button_sleeping = 0;
+    }
+}
+
+/**
+ * @brief Sleep until the next interrupt if no button edge is pending
+ * @note Call from the main loop once every button (and bank) is idle. SysTick is suspended
+ *       during the sleep so an idle keypad costs no periodic wakeup, unless a soft timer is
+ *       armed or keep_tick is set: the sleep then ends at the next SysTick so deadlines and
+ *       HAL_GetTick keep running. The check and WFI run with interrupts masked: an edge
+ *       arriving in between still ends WFI at once. PRIMASK is restored on return.
+ * @param keep_tick: 1 if the caller has other HAL_GetTick based work pending
+ * @return uint8_t: 1 if the MCU slept, 0 if an edge was pending
+ */
+uint8_t Button_Sleep(uint8_t keep_tick) {
+    uint8_t slept = 0;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (button_wake) {
+        button_power.skipped++;
+    } else {
+        uint8_t tickless = !keep_tick && !SoftTimer_Next(NULL);
+
+        button_sleeping = 1;
+        if (tickless) {
+            button_power.sleeps++;
+            HAL_SuspendTick();
+        } else {
+            button_power.ticked++;
         }
+        __WFI();
+        if (tickless) {
+            HAL_ResumeTick();
+        }
+        slept = 1;
     }
+    button_wake = 0;
+    __set_PRIMASK(primask);
+    __ISB();
+    // The interrupt that ended WFI has been served by now: a button edge counted as a wakeup
+    button_sleeping = 0;
+    return slept;
+}
+
+/**
+ * @brief Read the tickless mode counters
+ * @param stats: Destination for a snapshot of the counters
+ */
+void Button_GetPowerStats(ButtonPowerStats_t* stats) {
+    if (stats == NULL) return;
+
+    *stats = button_power;
 }
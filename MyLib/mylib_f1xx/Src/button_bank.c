@@ -0,0 +1,167 @@
+#include "button_bank.h"
+
+#include <string.h>
+
+/**
+ * @brief Initialize an empty button bank
+ * @param bank: Pointer to the bank
+ */
+void ButtonBank_Init(ButtonBank_t* bank) {
+    if (bank == NULL) return;
+
+    memset(bank, 0, sizeof(*bank));
+}
+
+/**
+ * @brief Move a button initialized with Button_Init into a bank
+ * @note The bank then debounces the pin, Button_Handle must no longer be called for it
+ * @param bank: Pointer to the bank
+ * @param p_button: Button on a single pin
+ * @return uint8_t: 1 on success, 0 if the bank has no room for its port
+ */
+uint8_t ButtonBank_Add(ButtonBank_t* bank, Button_t* p_button) {
+    if (bank == NULL || p_button == NULL || p_button->GPIO_Pin == 0) return 0;
+
+    ButtonPort_t* port = NULL;
+    for (uint8_t i = 0; i < bank->port_count; i++) {
+        if (bank->port[i].GPIOx == p_button->GPIOx) {
+            port = &bank->port[i];
+            break;
+        }
+    }
+    if (port == NULL) {
+        if (bank->port_count >= BTN_BANK_PORTS) return 0;
+        port = &bank->port[bank->port_count++];
+        port->GPIOx = p_button->GPIOx;
+        port->ct0 = 0xFFFF;
+        port->ct1 = 0xFFFF;
+    }
+
+    uint8_t pin = __builtin_ctz(p_button->GPIO_Pin);
+    port->mask |= p_button->GPIO_Pin;
+    if (p_button->active_level == BUTTON_ACTIVE_LOW) {
+        port->active_low |= p_button->GPIO_Pin;
+    }
+    port->button[pin] = p_button;
+    return 1;
+}
+
+/**
+ * @brief Debounce every pin of a port in one pass
+ * @note 2-bit vertical counters: a pin whose sample differs from its debounced state counts
+ *       down once per scan and toggles after 4 scans, any equal sample resets its counter.
+ * @param port: Pointer to the port
+ * @param idr: Sample of the port input register
+ * @return uint16_t: Pins whose debounced state toggled
+ */
+static uint16_t ButtonBank_Debounce(ButtonPort_t* port, uint16_t idr) {
+    uint16_t pressed = (idr ^ port->active_low) & port->mask;
+    uint16_t changed = port->state ^ pressed;
+
+    port->ct0 = ~(port->ct0 & changed);
+    port->ct1 = port->ct0 ^ (port->ct1 & changed);
+    changed &= port->ct0 & port->ct1;
+    port->state ^= changed;
+    return changed;
+}
+
+/**
+ * @brief Scan all ports of a bank and run the event logic of the buttons that need it
+ * @note Call from the main loop, scans every BTN_BANK_SCAN_PERIOD. Only buttons that toggled
+ *       run Button_Update, press deadlines run from SoftTimer_Process.
+ * @param bank: Pointer to the bank
+ * @param current_tick: Current system tick
+ */
+void ButtonBank_Scan(ButtonBank_t* bank, uint32_t current_tick) {
+    if (bank == NULL || (int32_t)(current_tick - bank->next_scan) < 0) return;
+
+    bank->next_scan = current_tick + BTN_BANK_SCAN_PERIOD;
+
+    for (uint8_t i = 0; i < bank->port_count; i++) {
+        ButtonBank_PortSample(&bank->port[i], (uint16_t)bank->port[i].GPIOx->IDR, current_tick);
+    }
+}
+
+/**
+ * @brief Debounce one sample of a port and run the event logic of the pins that toggled
+ * @note Used by ButtonBank_Scan, and by ButtonDma for samples taken by DMA
+ * @param port: Pointer to the port
+ * @param idr: Sample of the port input register
+ * @param current_tick: Tick of the sample
+ */
+void ButtonBank_PortSample(ButtonPort_t* port, uint16_t idr, uint32_t current_tick) {
+    uint16_t toggled = ButtonBank_Debounce(port, idr);
+
+    while (toggled) {
+        uint8_t pin = __builtin_ctz(toggled);
+        uint16_t bit = 1U << pin;
+        Button_t* p_button = port->button[pin];
+        toggled &= toggled - 1;
+
+        // Keep the Button_t view of the pin consistent with a debounced read
+        uint8_t level = ((port->state & bit) != 0) ^ ((port->active_low & bit) != 0);
+        p_button->btn_last = p_button->btn_current;
+        p_button->btn_current = level;
+        p_button->btn_filter = level;
+        Button_Update(p_button, 1, current_tick);
+    }
+}
+
+/**
+ * @brief Check if no pin of the bank is pressed or being debounced
+ * @note A pin whose counter left its rest value (3) has a change in progress
+ * @param bank: Pointer to the bank
+ * @return uint8_t: 1 if Button_Sleep can be used, 0 otherwise
+ */
+uint8_t ButtonBank_IsIdle(ButtonBank_t* bank) {
+    if (bank == NULL) return 1;
+
+    for (uint8_t i = 0; i < bank->port_count; i++) {
+        ButtonPort_t* port = &bank->port[i];
+        if (port->state != 0 || ((port->ct0 & port->ct1) & port->mask) != port->mask) return 0;
+    }
+    return 1;
+}
+
+#if BTN_BANK_BENCHMARK
+
+#define BENCH_BUTTONS   32
+
+static Button_t bench_button[BENCH_BUTTONS];
+static ButtonBank_t bench_bank;
+
+/**
+ * @brief Measure one poll of 1, 8 and 32 idle buttons, per button and as a bank
+ * @note Uses the 16 pins of GPIOA and GPIOB, which are only read. Cycles from DWT->CYCCNT.
+ * @param result: Receives the measures for 1, 8 and 32 buttons
+ */
+void ButtonBank_Benchmark(ButtonBenchmark_t result[3]) {
+    static const uint8_t counts[3] = { 1, 8, 32 };
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint8_t r = 0; r < 3; r++) {
+        uint8_t n = counts[r];
+
+        ButtonBank_Init(&bench_bank);
+        for (uint8_t i = 0; i < n; i++) {
+            Button_Init(&bench_button[i], (i < 16) ? GPIOA : GPIOB, 1U << (i % 16), BUTTON_ACTIVE_LOW);
+            ButtonBank_Add(&bench_bank, &bench_button[i]);
+        }
+
+        uint32_t start = DWT->CYCCNT;
+        for (uint8_t i = 0; i < n; i++) {
+            Button_Handle(&bench_button[i], HAL_GetTick());
+        }
+        result[r].cycles_single = DWT->CYCCNT - start;
+
+        bench_bank.next_scan = HAL_GetTick();
+        start = DWT->CYCCNT;
+        ButtonBank_Scan(&bench_bank, HAL_GetTick());
+        result[r].cycles_bank = DWT->CYCCNT - start;
+        result[r].buttons = n;
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include "button_dma.h"
+
+/**
+ * @brief Start sampling a port with its timer update DMA request
+ * @note The timer must already run at period_ms per update (e.g. 1 kHz with period_ms = 1).
+ *       The debounce then takes 4 samples, whatever the main loop is doing. Stop the
+ *       ButtonBank_Scan polling of this port while DMA sampling runs.
+ * @param dma: Pointer to the sampler
+ * @param port: Bank port whose GPIO is sampled
+ * @param htim: Timer whose update triggers the copies, hdma[TIM_DMA_ID_UPDATE] set by CubeMX
+ * @param period_ms: Timer period in milliseconds
+ * @return HAL_StatusTypeDef: HAL_OK if the DMA started
+ */
+HAL_StatusTypeDef ButtonDma_Start(ButtonDma_t* dma, ButtonPort_t* port, TIM_HandleTypeDef* htim, uint8_t period_ms) {
+    if (dma == NULL || port == NULL || htim == NULL || htim->hdma[TIM_DMA_ID_UPDATE] == NULL) {
+        return HAL_ERROR;
+    }
+
+    dma->port = port;
+    dma->htim = htim;
+    dma->hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+    dma->read = 0;
+    dma->period_ms = period_ms ? period_ms : 1;
+    dma->last_tick = HAL_GetTick();
+    dma->sample_tick = dma->last_tick + dma->period_ms;    // First copy comes one period later
+    dma->samples = 0;
+    dma->overruns = 0;
+
+    for (uint16_t i = 0; i < BTN_DMA_BUFFER; i++) {
+        dma->buffer[i] = (uint16_t)port->GPIOx->IDR;
+    }
+
+    if (HAL_DMA_Start(dma->hdma, (uint32_t)&port->GPIOx->IDR, (uint32_t)dma->buffer, BTN_DMA_BUFFER) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    __HAL_TIM_ENABLE_DMA(htim, TIM_DMA_UPDATE);
+    return HAL_TIM_Base_Start(htim);
+}
+
+/**
+ * @brief Stop the DMA sampling of a port
+ * @param dma: Pointer to the sampler
+ */
+void ButtonDma_Stop(ButtonDma_t* dma) {
+    if (dma == NULL || dma->htim == NULL) return;
+
+    __HAL_TIM_DISABLE_DMA(dma->htim, TIM_DMA_UPDATE);
+    HAL_DMA_Abort(dma->hdma);
+}
+
+/**
+ * @brief Debounce every sample written by the DMA since the last call
+ * @note Call from the main loop more often than every (BTN_DMA_BUFFER - 1) * period_ms.
+ *       Each sample is stamped with its own tick (period_ms apart), counted back from the
+ *       newest one, so event timing does not depend on when the batch is processed and the
+ *       timer cannot drift away from the SysTick. If the loop was late the DMA may have
+ *       overwritten unread samples: the batch restarts at the oldest sample still in the buffer.
+ * @param dma: Pointer to the sampler
+ * @param current_tick: Current system tick
+ */
+void ButtonDma_Process(ButtonDma_t* dma, uint32_t current_tick) {
+    if (dma == NULL || dma->hdma == NULL) return;
+
+    uint16_t write = BTN_DMA_BUFFER - (uint16_t)__HAL_DMA_GET_COUNTER(dma->hdma);
+    if (write >= BTN_DMA_BUFFER) {
+        write = 0;
+    }
+
+    uint16_t count = (uint16_t)(write + BTN_DMA_BUFFER - dma->read) % BTN_DMA_BUFFER;
+    uint32_t elapsed = current_tick - dma->last_tick;
+    dma->last_tick = current_tick;
+
+    // The previous call read up to the DMA position. A full lap leaves the positions equal
+    // (or a few samples apart), and with the tick rounding BTN_DMA_BUFFER - 1 periods may
+    // already hold BTN_DMA_BUFFER copies, so from there on the whole buffer counts as new.
+    if (elapsed >= (uint32_t)(BTN_DMA_BUFFER - 1) * dma->period_ms) {
+        dma->overruns++;
+        dma->read = write;
+        count = BTN_DMA_BUFFER;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // The newest sample was copied within the last period: stamp it now and the others one
+    // period apart before it, but never before the last sample of the previous batch
+    uint32_t first = current_tick - (uint32_t)(count - 1) * dma->period_ms;
+    uint32_t previous = dma->sample_tick - dma->period_ms;
+    dma->sample_tick = ((int32_t)(first - previous) < 0) ? previous : first;
+
+    while (count--) {
+        ButtonBank_PortSample(dma->port, dma->buffer[dma->read], dma->sample_tick);
+        dma->sample_tick += dma->period_ms;
+        if (++dma->read >= BTN_DMA_BUFFER) {
+            dma->read = 0;
+        }
+        dma->samples++;
+    }
+}
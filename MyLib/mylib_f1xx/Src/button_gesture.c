@@ -0,0 +1,190 @@
+#include "button_gesture.h"
+
+static void ButtonGesture_Deadline(SoftTimer_t* timer, uint32_t current_tick);
+
+/**
+ * @brief Initialize a gesture engine and index its table by button
+ * @note A CLICKS gesture that could still grow into another gesture of the same button
+ *       (more clicks, or the same clicks followed by a hold) waits GESTURE_GAP_TIME after
+ *       the last release before it fires. The others fire on the release itself.
+ * @param engine: Pointer to the engine
+ * @param table: Gesture table, kept by reference
+ * @param count: Number of gestures (at most GESTURE_MAX)
+ * @param handler: Called with the table index of a recognized gesture
+ */
+void ButtonGesture_Init(ButtonGestureEngine_t* engine, const ButtonGesture_t* table, uint8_t count,
+                        void (*handler)(uint8_t)) {
+    if (engine == NULL || table == NULL) return;
+
+    engine->table = table;
+    engine->count = (count > GESTURE_MAX) ? GESTURE_MAX : count;
+    engine->wait = 0;
+    engine->armed = 0;
+    engine->handler = handler;
+    SoftTimer_Init(&engine->timer, ButtonGesture_Deadline, engine);
+
+    for (uint8_t b = 0; b < GESTURE_BUTTONS; b++) {
+        engine->index[b] = 0;
+        engine->button[b] = (GestureButton_t){0};
+    }
+
+    for (uint8_t g = 0; g < engine->count; g++) {
+        const ButtonGesture_t* gesture = &table[g];
+
+        if (gesture->button < GESTURE_BUTTONS) {
+            engine->index[gesture->button] |= 1U << g;
+        }
+        if (gesture->type == GESTURE_TYPE_CHORD && gesture->button2 < GESTURE_BUTTONS) {
+            engine->index[gesture->button2] |= 1U << g;
+        }
+    }
+
+    for (uint8_t g = 0; g < engine->count; g++) {
+        const ButtonGesture_t* gesture = &table[g];
+        if (gesture->type != GESTURE_TYPE_CLICKS) continue;
+
+        for (uint8_t o = 0; o < engine->count; o++) {
+            const ButtonGesture_t* other = &table[o];
+            if (other->button != gesture->button) continue;
+
+            if ((other->type == GESTURE_TYPE_CLICKS && other->clicks > gesture->clicks) ||
+                (other->type == GESTURE_TYPE_CLICK_HOLD && other->clicks >= gesture->clicks)) {
+                engine->wait |= 1U << g;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Report a recognized gesture and end the click sequence it consumed
+ * @param engine: Pointer to the engine
+ * @param g: Table index
+ */
+static void ButtonGesture_Fire(ButtonGestureEngine_t* engine, uint8_t g) {
+    const ButtonGesture_t* gesture = &engine->table[g];
+
+    engine->armed &= ~(1U << g);
+    if (gesture->type != GESTURE_TYPE_CHORD) {
+        engine->button[gesture->button].clicks = 0;
+    }
+    if (engine->handler != NULL) {
+        engine->handler(g);
+    }
+}
+
+/**
+ * @brief Fire the armed gestures that are due and arm the timer for the next one
+ * @param engine: Pointer to the engine
+ * @param current_tick: Current system tick
+ */
+static void ButtonGesture_Schedule(ButtonGestureEngine_t* engine, uint32_t current_tick) {
+    uint16_t armed = engine->armed;
+    uint8_t have_next = 0;
+    uint32_t next = 0;
+
+    while (armed) {
+        uint8_t g = __builtin_ctz(armed);
+        armed &= armed - 1;
+
+        if ((int32_t)(current_tick - engine->deadline[g]) >= 0) {
+            ButtonGesture_Fire(engine, g);
+        } else if (!have_next || (int32_t)(engine->deadline[g] - next) < 0) {
+            next = engine->deadline[g];
+            have_next = 1;
+        }
+    }
+
+    if (have_next) {
+        SoftTimer_Start(&engine->timer, next);
+    } else {
+        SoftTimer_Stop(&engine->timer);
+    }
+}
+
+/**
+ * @brief Timer callback of the engine
+ * @param timer: Engine timer
+ * @param current_tick: Current system tick
+ */
+static void ButtonGesture_Deadline(SoftTimer_t* timer, uint32_t current_tick) {
+    ButtonGesture_Schedule((ButtonGestureEngine_t*)timer->context, current_tick);
+}
+
+/**
+ * @brief Feed one button event
+ * @note Only PRESSED and RELEASED are used, so any event source works: a Button_t callback,
+ *       a ButtonPanel handler or records popped from the button queue. Only the gestures
+ *       indexed under the button are visited.
+ * @param engine: Pointer to the engine
+ * @param id: Button id
+ * @param event: Button event type
+ * @param current_tick: Timestamp of the event
+ */
+void ButtonGesture_Event(ButtonGestureEngine_t* engine, uint8_t id, ButtonEvent event, uint32_t current_tick) {
+    if (engine == NULL || id >= GESTURE_BUTTONS) return;
+    if (event != BUTTON_EVENT_PRESSED && event != BUTTON_EVENT_RELEASED) return;
+
+    GestureButton_t* button = &engine->button[id];
+    uint16_t gestures = engine->index[id];
+
+    if (event == BUTTON_EVENT_PRESSED) {
+        button->pressed = 1;
+        button->press_time = current_tick;
+        if (current_tick - button->release_time > GESTURE_GAP_TIME) {
+            button->clicks = 0;                 // Too late to continue the sequence
+        }
+    } else {
+        button->pressed = 0;
+        button->release_time = current_tick;
+        if (current_tick - button->press_time < GESTURE_CLICK_TIME) {
+            button->clicks++;
+        } else {
+            button->clicks = 0;
+        }
+    }
+
+    while (gestures) {
+        uint8_t g = __builtin_ctz(gestures);
+        const ButtonGesture_t* gesture = &engine->table[g];
+        gestures &= gestures - 1;
+
+        switch (gesture->type) {
+            case GESTURE_TYPE_CLICKS:
+                if (event == BUTTON_EVENT_PRESSED) {
+                    engine->armed &= ~(1U << g);    // The sequence goes on
+                } else if (button->clicks == gesture->clicks) {
+                    if (engine->wait & (1U << g)) {
+                        engine->deadline[g] = current_tick + GESTURE_GAP_TIME;
+                        engine->armed |= 1U << g;
+                    } else {
+                        ButtonGesture_Fire(engine, g);
+                    }
+                }
+                break;
+
+            case GESTURE_TYPE_CLICK_HOLD:
+                if (event == BUTTON_EVENT_PRESSED && button->clicks == gesture->clicks) {
+                    engine->deadline[g] = current_tick + gesture->time_ms;
+                    engine->armed |= 1U << g;
+                } else {
+                    engine->armed &= ~(1U << g);
+                }
+                break;
+
+            case GESTURE_TYPE_CHORD:
+                if (event == BUTTON_EVENT_PRESSED &&
+                    engine->button[gesture->button].pressed && engine->button[gesture->button2].pressed) {
+                    engine->deadline[g] = current_tick + gesture->time_ms;
+                    engine->armed |= 1U << g;
+                } else {
+                    engine->armed &= ~(1U << g);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    ButtonGesture_Schedule(engine, current_tick);
+}
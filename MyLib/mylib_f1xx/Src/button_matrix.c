@@ -0,0 +1,172 @@
+#include "button_matrix.h"
+
+/**
+ * @brief Initialize a keypad matrix
+ * @note GPIO modes are set by MX_GPIO_Init. The panel must be initialized first with
+ *       ButtonPanel_Init(panel, rows * 8, handler).
+ * @param matrix: Pointer to the matrix
+ * @param panel: Panel that receives the debounced keys
+ * @param row_port: Port of the row outputs
+ * @param row_pins: Pin mask of each row
+ * @param rows: Number of rows (at most BTN_MATRIX_ROWS)
+ * @param col_port: Port of the column inputs
+ * @param col_shift: Pin number of the first column
+ * @param cols: Number of columns (at most BTN_MATRIX_COLS)
+ * @param settle_ns: Wait before reading the columns of a row, 0 for BTN_MATRIX_SETTLE_NS.
+ *        Converted to cycles with SystemCoreClock, call after SystemClock_Config.
+ */
+void ButtonMatrix_Init(ButtonMatrix_t* matrix, ButtonPanel_t* panel,
+                       GPIO_TypeDef* row_port, const uint16_t* row_pins, uint8_t rows,
+                       GPIO_TypeDef* col_port, uint8_t col_shift, uint8_t cols, uint16_t settle_ns) {
+    if (matrix == NULL || panel == NULL || row_pins == NULL) return;
+
+    if (rows > BTN_MATRIX_ROWS) rows = BTN_MATRIX_ROWS;
+    if (cols > BTN_MATRIX_COLS) cols = BTN_MATRIX_COLS;
+
+    matrix->row_port = row_port;
+    matrix->row_mask = 0;
+    for (uint8_t r = 0; r < rows; r++) {
+        matrix->row_pin[r] = row_pins[r];
+        matrix->row_mask |= row_pins[r];
+        matrix->raw[r] = 0;
+    }
+    matrix->rows = rows;
+    matrix->col_port = col_port;
+    matrix->col_shift = col_shift;
+    matrix->cols = cols;
+    if (settle_ns == 0) settle_ns = BTN_MATRIX_SETTLE_NS;
+    uint32_t settle = (SystemCoreClock / 1000000U) * settle_ns / 1000U;
+    matrix->settle = (settle > 0xFFFF) ? 0xFFFF : (uint16_t)settle;
+    matrix->diodes = 0;
+
+    for (uint8_t w = 0; w < 2; w++) {
+        matrix->state[w] = 0;
+        matrix->ct0[w] = 0xFFFFFFFF;
+        matrix->ct1[w] = 0xFFFFFFFF;
+    }
+    matrix->changed = 0;
+    matrix->ghost_scans = 0;
+    matrix->scan_cycles = 0;
+    matrix->next_scan = 0;
+    matrix->panel = panel;
+
+    // All rows released
+    row_port->BSRR = matrix->row_mask;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Hold back the rows that may show ghost keys
+ * @note Without diodes, three keys on the corners of a rectangle make the fourth corner read
+ *       as pressed. Two rows sharing two or more columns are ambiguous: they keep their
+ *       debounced state until the pattern resolves.
+ * @param matrix: Pointer to the matrix
+ * @param sample: Sample of this scan, key id bit
+ */
+static void ButtonMatrix_Ghosting(ButtonMatrix_t* matrix, uint32_t sample[2]) {
+    uint8_t ambiguous = 0;
+
+    for (uint8_t r1 = 0; r1 < matrix->rows; r1++) {
+        if (matrix->raw[r1] == 0) continue;
+
+        for (uint8_t r2 = r1 + 1; r2 < matrix->rows; r2++) {
+            uint8_t common = matrix->raw[r1] & matrix->raw[r2];
+            if (common & (common - 1)) {
+                ambiguous |= (1U << r1) | (1U << r2);
+            }
+        }
+    }
+    if (ambiguous == 0) return;
+
+    matrix->ghost_scans++;
+    while (ambiguous) {
+        uint8_t r = __builtin_ctz(ambiguous);
+        uint32_t row_bits = 0xFFUL << ((r & 3) * 8);
+        ambiguous &= ambiguous - 1;
+
+        sample[r >> 2] = (sample[r >> 2] & ~row_bits) | (matrix->state[r >> 2] & row_bits);
+    }
+}
+
+/**
+ * @brief Scan every row once and debounce the whole matrix
+ * @note Touches only the matrix and its GPIO, so it can run from a timer interrupt with
+ *       ButtonMatrix_Process in the main loop. One BSRR write per row releases the previous
+ *       row and drives the next one, one IDR read returns all columns.
+ * @param matrix: Pointer to the matrix
+ */
+void ButtonMatrix_Sample(ButtonMatrix_t* matrix) {
+    if (matrix == NULL) return;
+
+    uint32_t start = DWT->CYCCNT;
+    GPIO_TypeDef* row_port = matrix->row_port;
+    GPIO_TypeDef* col_port = matrix->col_port;
+    uint8_t col_mask = (uint8_t)((1U << matrix->cols) - 1);
+    uint16_t previous = 0;
+    uint8_t busy_rows = 0;
+    uint32_t sample[2] = { 0, 0 };
+
+    for (uint8_t r = 0; r < matrix->rows; r++) {
+        uint16_t pin = matrix->row_pin[r];
+
+        row_port->BSRR = previous | ((uint32_t)pin << 16);
+        previous = pin;
+        uint32_t driven = DWT->CYCCNT;
+        while (DWT->CYCCNT - driven < matrix->settle) {
+        }
+
+        uint8_t cols = (uint8_t)(~col_port->IDR >> matrix->col_shift) & col_mask;
+        matrix->raw[r] = cols;
+        sample[r >> 2] |= (uint32_t)cols << ((r & 3) * 8);
+        busy_rows += (cols != 0);
+    }
+    row_port->BSRR = previous;
+
+    if (!matrix->diodes && busy_rows >= 2) {
+        ButtonMatrix_Ghosting(matrix, sample);
+    }
+
+    // Same 2-bit vertical counters as ButtonBank, 32 keys per word
+    for (uint8_t w = 0; w < 2; w++) {
+        uint32_t changed = matrix->state[w] ^ sample[w];
+
+        matrix->ct0[w] = ~(matrix->ct0[w] & changed);
+        matrix->ct1[w] = matrix->ct0[w] ^ (matrix->ct1[w] & changed);
+        changed &= matrix->ct0[w] & matrix->ct1[w];
+        matrix->state[w] ^= changed;
+        if (changed) {
+            matrix->changed = 1;
+        }
+    }
+
+    matrix->scan_cycles = DWT->CYCCNT - start;
+}
+
+/**
+ * @brief Hand the debounced keys to the panel if anything changed
+ * @param matrix: Pointer to the matrix
+ * @param current_tick: Current system tick
+ */
+void ButtonMatrix_Process(ButtonMatrix_t* matrix, uint32_t current_tick) {
+    if (matrix == NULL || !matrix->changed) return;
+
+    matrix->changed = 0;
+    for (uint8_t w = 0; w < 2; w++) {
+        ButtonPanel_Update(matrix->panel, w, matrix->state[w], current_tick);
+    }
+}
+
+/**
+ * @brief Scan the matrix every BTN_MATRIX_SCAN_PERIOD from the main loop
+ * @param matrix: Pointer to the matrix
+ * @param current_tick: Current system tick
+ */
+void ButtonMatrix_Scan(ButtonMatrix_t* matrix, uint32_t current_tick) {
+    if (matrix == NULL || (int32_t)(current_tick - matrix->next_scan) < 0) return;
+
+    matrix->next_scan = current_tick + BTN_MATRIX_SCAN_PERIOD;
+    ButtonMatrix_Sample(matrix);
+    ButtonMatrix_Process(matrix, current_tick);
+}
@@ -0,0 +1,234 @@
+#include "button_panel.h"
+
+static void ButtonPanel_Deadline(SoftTimer_t* timer, uint32_t current_tick);
+
+/**
+ * @brief Initialize a panel, all keys released
+ * @note Timing starts at the BTN_* defaults and can be changed in panel->timing.
+ *       HOLD is reported only if panel->hold is set, key[id].repeat counts the hold events.
+ * @param panel: Pointer to the panel
+ * @param count: Number of keys (at most BTN_PANEL_KEYS)
+ * @param handler: Called with the key index and the event
+ */
+void ButtonPanel_Init(ButtonPanel_t* panel, uint8_t count, void (*handler)(uint8_t, ButtonEvent)) {
+    if (panel == NULL) return;
+
+    for (uint8_t i = 0; i < BTN_PANEL_KEYS; i++) {
+        panel->key[i] = (ButtonKey_t){0};
+    }
+    for (uint8_t i = 0; i < BTN_PANEL_WORDS; i++) {
+        panel->pressed[i] = 0;
+        panel->active[i] = 0;
+    }
+    panel->count = (count > BTN_PANEL_KEYS) ? BTN_PANEL_KEYS : count;
+    panel->hold = 0;
+    panel->repeat_profile = NULL;
+    panel->timing.short_ms = BTN_SHORT_THRESHOLD;
+    panel->timing.long_ms = BTN_LONG_THRESHOLD;
+    panel->timing.very_long_ms = BTN_VERY_LONG_THRESHOLD;
+    panel->timing.double_ms = BTN_DOUBLE_PRESS_INTERVAL;
+    panel->timing.hold_ms = BTN_HOLD_INTERVAL;
+    panel->timing.debounce_ms = BTN_DEBOUNCE_TIME;
+    panel->handler = handler;
+    SoftTimer_Init(&panel->timer, ButtonPanel_Deadline, panel);
+}
+
+/**
+ * @brief Report an event of a key
+ * @param panel: Pointer to the panel
+ * @param id: Key index
+ * @param event: Button event type
+ */
+static inline void ButtonPanel_Emit(ButtonPanel_t* panel, uint8_t id, ButtonEvent event) {
+    if (panel->handler != NULL) {
+        panel->handler(id, event);
+    }
+}
+
+/**
+ * @brief Apply a debounced press or release of one key
+ * @param panel: Pointer to the panel
+ * @param id: Key index
+ * @param pressed: New state of the key
+ * @param now: Low 16 bits of the current tick
+ */
+static void ButtonPanel_Edge(ButtonPanel_t* panel, uint8_t id, uint8_t pressed, uint16_t now) {
+    ButtonKey_t* key = &panel->key[id];
+
+    if (pressed) {
+        key->pressed = 1;
+        key->long_sent = 0;
+        key->very_long_sent = 0;
+        key->repeat = 0;
+        uint8_t is_double = key->double_wait && (uint16_t)(now - key->press_time) < panel->timing.double_ms;
+        key->press_time = now;
+        key->hold_time = now;
+        ButtonPanel_Emit(panel, id, BUTTON_EVENT_PRESSED);
+
+        // Same rule as Button_Update: two presses closer than double_ms
+        if (is_double) {
+            key->double_wait = 0;
+            ButtonPanel_Emit(panel, id, BUTTON_EVENT_DOUBLE_PRESS);
+        } else {
+            key->double_wait = 1;
+        }
+    } else {
+        uint16_t press_duration = now - key->press_time;
+
+        key->pressed = 0;
+        ButtonPanel_Emit(panel, id, BUTTON_EVENT_RELEASED);
+
+        if (!key->long_sent && !key->very_long_sent && press_duration < panel->timing.short_ms) {
+            ButtonPanel_Emit(panel, id, BUTTON_EVENT_SHORT_PRESS);
+        }
+    }
+}
+
+/**
+ * @brief Delay before hold event number repeat + 1
+ * @param panel: Pointer to the panel
+ * @param repeat: Hold events already reported
+ * @return uint16_t: Interval in ticks
+ */
+static inline uint16_t ButtonPanel_HoldInterval(ButtonPanel_t* panel, uint16_t repeat) {
+    const ButtonRepeatProfile_t* profile = panel->repeat_profile;
+
+    if (profile == NULL || profile->length == 0) {
+        return panel->timing.hold_ms;
+    }
+    return profile->interval[(repeat < profile->length) ? repeat : profile->length - 1];
+}
+
+/**
+ * @brief Fire the due deadlines of one key and return its next one
+ * @param panel: Pointer to the panel
+ * @param id: Key index
+ * @param now: Low 16 bits of the current tick
+ * @param next: Ticks until the next deadline, lowered if this key has an earlier one
+ * @return uint8_t: 1 if the key still has a deadline, 0 if it went idle
+ */
+static uint8_t ButtonPanel_Key(ButtonPanel_t* panel, uint8_t id, uint16_t now, uint16_t* next) {
+    ButtonKey_t* key = &panel->key[id];
+    ButtonTiming_t* timing = &panel->timing;
+    uint16_t due = UINT16_MAX;
+
+    if (key->double_wait) {
+        uint16_t elapsed = now - key->press_time;
+        if (elapsed >= timing->double_ms) {
+            key->double_wait = 0;               // Also keeps the 16-bit stamps from aliasing
+        } else {
+            due = timing->double_ms - elapsed;
+        }
+    }
+
+    if (key->pressed) {
+        uint16_t press_duration = now - key->press_time;
+
+        if (!key->very_long_sent) {
+            if (press_duration >= timing->very_long_ms) {
+                key->very_long_sent = 1;
+                ButtonPanel_Emit(panel, id, BUTTON_EVENT_VERY_LONG_PRESS);
+            } else if (!key->long_sent && press_duration >= timing->long_ms) {
+                key->long_sent = 1;
+                ButtonPanel_Emit(panel, id, BUTTON_EVENT_LONG_PRESS);
+            }
+        }
+        if (!key->very_long_sent) {
+            uint16_t target = key->long_sent ? timing->very_long_ms : timing->long_ms;
+            if ((uint16_t)(target - press_duration) < due) due = target - press_duration;
+        }
+
+        // Each hold is stamped at its deadline, so no drift accumulates
+        if (panel->hold) {
+            uint16_t hold_due = key->hold_time + ButtonPanel_HoldInterval(panel, key->repeat);
+            if ((int16_t)(now - hold_due) >= 0) {
+                key->repeat++;
+                key->hold_time = hold_due;
+                hold_due += ButtonPanel_HoldInterval(panel, key->repeat);
+                ButtonPanel_Emit(panel, id, BUTTON_EVENT_HOLD);
+            }
+            // A late pass can leave the next hold already due: catch up on the next tick
+            int16_t hold_left = (int16_t)(hold_due - now);
+            if (hold_left <= 0) {
+                due = 0;
+            } else if ((uint16_t)hold_left < due) {
+                due = hold_left;
+            }
+        }
+    }
+
+    if (due < *next) *next = due;
+    return key->pressed || key->double_wait;
+}
+
+/**
+ * @brief Run the deadlines of all active keys and arm the panel timer for the next one
+ * @note Called from the panel timer, and by ButtonPanel_Update after the edges
+ * @param panel: Pointer to the panel
+ * @param current_tick: Current system tick
+ */
+void ButtonPanel_Process(ButtonPanel_t* panel, uint32_t current_tick) {
+    if (panel == NULL) return;
+
+    uint16_t now = (uint16_t)current_tick;
+    uint16_t next = UINT16_MAX;
+
+    for (uint8_t w = 0; w < BTN_PANEL_WORDS; w++) {
+        uint32_t active = panel->active[w];
+
+        while (active) {
+            uint8_t bit = __builtin_ctz(active);
+            active &= active - 1;
+
+            if (!ButtonPanel_Key(panel, w * 32 + bit, now, &next)) {
+                panel->active[w] &= ~(1UL << bit);
+            }
+        }
+    }
+
+    if (next == UINT16_MAX) {
+        SoftTimer_Stop(&panel->timer);
+    } else {
+        SoftTimer_Start(&panel->timer, current_tick + (next ? next : 1));
+    }
+}
+
+/**
+ * @brief Timer callback of the panel
+ * @param timer: Panel timer
+ * @param current_tick: Current system tick
+ */
+static void ButtonPanel_Deadline(SoftTimer_t* timer, uint32_t current_tick) {
+    ButtonPanel_Process((ButtonPanel_t*)timer->context, current_tick);
+}
+
+/**
+ * @brief Feed the debounced state of 32 keys
+ * @note Keys are word * 32 + bit. The state can come from a ButtonPort_t (port->state) or
+ *       a matrix scan. Only the keys that changed are visited.
+ * @param panel: Pointer to the panel
+ * @param word: Index of the 32-key group
+ * @param state: Debounced state of the group, 1 = pressed
+ * @param current_tick: Current system tick
+ */
+void ButtonPanel_Update(ButtonPanel_t* panel, uint8_t word, uint32_t state, uint32_t current_tick) {
+    if (panel == NULL || word >= BTN_PANEL_WORDS) return;
+
+    uint32_t changed = state ^ panel->pressed[word];
+    if (changed == 0) return;
+
+    uint16_t now = (uint16_t)current_tick;
+    panel->pressed[word] = state;
+
+    while (changed) {
+        uint8_t bit = __builtin_ctz(changed);
+        uint8_t id = word * 32 + bit;
+        changed &= changed - 1;
+
+        if (id >= panel->count) break;
+        ButtonPanel_Edge(panel, id, (state >> bit) & 1, now);
+        panel->active[word] |= 1UL << bit;
+    }
+
+    ButtonPanel_Process(panel, current_tick);
+}
@@ -0,0 +1,149 @@
+#include "button_sim.h"
+
+#if BTN_SIM_ENABLE
+
+static Button_t* sim_buttons;
+static uint8_t sim_level[BTN_SIM_BUTTONS];
+static uint32_t sim_edge[BTN_SIM_BUTTONS];  // Tick of the last edge of each button
+
+/**
+ * @brief Read hook: level of a simulated button
+ * @param p_button: Pointer to the Button structure
+ * @return uint8_t: Level set by the trace
+ */
+static uint8_t ButtonSim_Read(Button_t* p_button) {
+    return sim_level[p_button - sim_buttons];
+}
+
+/**
+ * @brief Move the queued events into the result
+ * @param start_tick: Virtual tick of offset 0
+ * @param events: Receives the detected events, can be NULL
+ * @param max_events: Capacity of events
+ * @param r: Counters being accumulated
+ */
+static void ButtonSim_Drain(uint32_t start_tick, ButtonSimEvent_t* events, uint16_t max_events,
+                            ButtonSimResult_t* r) {
+    ButtonEventRecord_t record;
+
+    while (Button_PopEvent(&record)) {
+        uint32_t offset = record.tick - start_tick;
+        uint32_t latency = offset - sim_edge[record.id];
+        if (latency > UINT16_MAX) latency = UINT16_MAX;
+
+        if (record.event == BUTTON_EVENT_PRESSED || record.event == BUTTON_EVENT_RELEASED) {
+            if (latency < r->latency_min) r->latency_min = latency;
+            if (latency > r->latency_max) r->latency_max = latency;
+        }
+        if (events != NULL && r->events < max_events) {
+            events[r->events].tick = offset;
+            events[r->events].button = record.id;
+            events[r->events].event = record.event;
+            events[r->events].latency = latency;
+        }
+        r->events++;
+    }
+}
+
+/**
+ * @brief Append a bouncing edge to a trace
+ * @note The pin toggles bounces times, spacing ticks apart, before settling to level
+ * @param trace: Trace being built, sorted by tick
+ * @param len: Entries already in the trace
+ * @param size: Capacity of the trace
+ * @param tick: Tick of the first bounce
+ * @param button: Button index
+ * @param level: Final level
+ * @param bounces: Number of glitches before the final level
+ * @param spacing: Ticks between toggles
+ * @return uint16_t: New length of the trace
+ */
+uint16_t ButtonSim_AddBounce(ButtonSimEdge_t* trace, uint16_t len, uint16_t size, uint32_t tick,
+                             uint8_t button, uint8_t level, uint8_t bounces, uint8_t spacing) {
+    for (uint8_t i = 0; i <= bounces && len < size; i++) {
+        // Odd glitches go back to the old level, the last entry is the final one
+        trace[len].tick = tick + (uint32_t)i * spacing;
+        trace[len].button = button;
+        trace[len].level = ((bounces - i) & 1) ? !level : level;
+        len++;
+    }
+    return len;
+}
+
+/**
+ * @brief Drive Button_Handle from an edge trace with a virtual tick
+ * @note The buttons must be initialized (Button_Init). They are switched to queue mode
+ *       (id = index, all events) so each event gets its tick. The queue is drained after
+ *       every Button_Handle call and every timer callback, so BTN_QUEUE_SIZE only has to
+ *       cover the events of one button. start_tick close to 0xFFFFFFFF exercises the tick
+ *       wrap. At the end the read hook is restored, the buttons go back to callback mode
+ *       and their timers are stopped.
+ * @param buttons: Array of simulated buttons
+ * @param count: Number of buttons (at most BTN_SIM_BUTTONS)
+ * @param trace: Edges sorted by tick, ticks are offsets from start_tick
+ * @param trace_len: Number of edges
+ * @param start_tick: Virtual tick of offset 0
+ * @param duration: Ticks to simulate
+ * @param events: Receives the detected events, can be NULL
+ * @param max_events: Capacity of events
+ * @param result: Receives the counters
+ */
+void ButtonSim_Run(Button_t* buttons, uint8_t count, const ButtonSimEdge_t* trace, uint16_t trace_len,
+                   uint32_t start_tick, uint32_t duration,
+                   ButtonSimEvent_t* events, uint16_t max_events, ButtonSimResult_t* result) {
+    if (buttons == NULL || result == NULL) return;
+    if (count > BTN_SIM_BUTTONS) count = BTN_SIM_BUTTONS;
+
+    ButtonSimResult_t r = { 0 };
+    uint32_t dropped = Button_QueueDropped();
+    uint16_t next_edge = 0;
+    ButtonEventRecord_t record;
+
+    r.latency_min = UINT16_MAX;
+    sim_buttons = buttons;
+    for (uint8_t i = 0; i < count; i++) {
+        sim_level[i] = buttons[i].btn_filter;
+        sim_edge[i] = 0;
+        Button_EnableQueue(&buttons[i], i, BUTTON_EVENT_ALL);
+    }
+    Button_SetReadHook(ButtonSim_Read);
+    while (Button_PopEvent(&record)) {
+    }
+
+    for (uint32_t t = 0; t < duration; t++) {
+        uint32_t now = start_tick + t;
+
+        while (next_edge < trace_len && trace[next_edge].tick <= t) {
+            const ButtonSimEdge_t* edge = &trace[next_edge++];
+            if (edge->button < count) {
+                sim_level[edge->button] = edge->level;
+                sim_edge[edge->button] = t;
+            }
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            uint32_t start = BTN_SIM_CYCLES();
+            Button_Handle(&buttons[i], now);
+            uint32_t cycles = BTN_SIM_CYCLES() - start;
+
+            r.cycles_total += cycles;
+            if (cycles > r.cycles_max) r.cycles_max = cycles;
+            ButtonSim_Drain(start_tick, events, max_events, &r);
+        }
+        r.calls += count;
+
+        while (SoftTimer_ProcessOne(now)) {
+            ButtonSim_Drain(start_tick, events, max_events, &r);
+        }
+    }
+
+    Button_SetReadHook(NULL);
+    for (uint8_t i = 0; i < count; i++) {
+        Button_EnableQueue(&buttons[i], 0, 0);
+        SoftTimer_Stop(&buttons[i].timer);
+    }
+    r.dropped = Button_QueueDropped() - dropped;
+    *result = r;
+}
+
+#endif
@@ -0,0 +1,435 @@
+#include "cfg_store.h"
+#include "print_cli.h"
+#include "cli_types.h"
+#include "cli_rpc.h"
+
+#include <string.h>
+
+/*
+ * EEPROM emulation on two flash pages, as in ST's AN2594.
+ * Each page starts with a status half-word and a reserved half-word, then 4 byte records
+ * {value, key}. Records are only appended, the last record of a key wins. The value is
+ * programmed before the key, so a record interrupted by a reset has no key and is skipped.
+ * When the page is full the current values are copied to the other page, which spreads
+ * the erases over both pages.
+ */
+
+#define CFG_RECORD_FIRST		4
+#define CFG_RECORD_SIZE			4
+#define CFG_RECORD_SLOTS		((CFG_STORE_PAGE_SIZE - CFG_RECORD_FIRST) / CFG_RECORD_SIZE)
+#define CFG_KEY_NONE			0xFFFF
+
+#define CFG_READ16(addr)		(*(__IO uint16_t*)(addr))
+
+typedef struct
+{
+	uint32_t page;				// Address of the valid page
+	uint16_t next;				// Next free record slot
+	uint32_t dirty;				// Keys changed in RAM but not yet in flash, one bit per key
+	uint32_t present;			// Keys that have a value
+	uint32_t changed_tick;		// Tick of the last change, commits wait CFG_STORE_COMMIT_DELAY after it
+	uint8_t failed;				// The last commit failed, the next one rewrites the page
+	uint32_t failed_tick;		// Tick of that commit
+	uint32_t retry_delay;		// Wait before CfgStore_Process tries again
+	int16_t value[CFG_STORE_KEYS];
+	cfg_store_stats_t stats;
+} cfg_store_t;
+
+static cfg_store_t cfg;
+
+extern uint32_t _sidata, _sdata, _edata;	// From the linker script, as used by the startup code
+
+/**
+ * @brief Check that the image stored in flash ends before the first page of the store
+ * @note The last thing in flash is the initial content of .data, at _sidata
+ */
+static uint8_t CfgStore_Reserved(void)
+{
+	uint32_t image_end = (uint32_t) &_sidata + ((uint32_t) &_edata - (uint32_t) &_sdata);
+	return image_end <= CFG_STORE_PAGE0;
+}
+
+static uint32_t CfgStore_Other(uint32_t page)
+{
+	return (page == CFG_STORE_PAGE0) ? CFG_STORE_PAGE1 : CFG_STORE_PAGE0;
+}
+
+static HAL_StatusTypeDef CfgStore_Program(uint32_t addr, uint16_t data)
+{
+	HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, data);
+	if (status != HAL_OK)
+	{
+		cfg.stats.errors++;
+	}
+	return status;
+}
+
+static HAL_StatusTypeDef CfgStore_Erase(uint32_t page)
+{
+	FLASH_EraseInitTypeDef erase = { 0 };
+	uint32_t error;
+
+	erase.TypeErase = FLASH_TYPEERASE_PAGES;
+	erase.PageAddress = page;
+	erase.NbPages = 1;
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &error);
+	if (status != HAL_OK)
+	{
+		cfg.stats.errors++;
+	}
+	return status;
+}
+
+static HAL_StatusTypeDef CfgStore_WriteRecord(uint32_t page, uint16_t slot, uint16_t key, int16_t value)
+{
+	uint32_t addr = page + CFG_RECORD_FIRST + slot * CFG_RECORD_SIZE;
+
+	if (CfgStore_Program(addr, (uint16_t) value) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	cfg.stats.writes++;
+	return CfgStore_Program(addr + 2, key);
+}
+
+/**
+ * @brief Rebuild the RAM index from a page
+ * @note Bounded by CFG_RECORD_SLOTS reads, stops at the first blank slot
+ */
+static void CfgStore_Scan(uint32_t page)
+{
+	uint16_t slot;
+
+	cfg.page = page;
+	cfg.present = 0;
+	cfg.stats.records = 0;
+	for (slot = 0; slot < CFG_RECORD_SLOTS; slot++)
+	{
+		uint32_t addr = page + CFG_RECORD_FIRST + slot * CFG_RECORD_SIZE;
+		uint16_t value = CFG_READ16(addr);
+		uint16_t key = CFG_READ16(addr + 2);
+
+		if (key == CFG_KEY_NONE && value == 0xFFFF)
+		{
+			break;
+		}
+		if (key < CFG_STORE_KEYS)
+		{
+			cfg.value[key] = (int16_t) value;
+			cfg.present |= 1UL << key;
+			cfg.stats.records++;
+		}
+	}
+	cfg.next = slot;
+}
+
+/**
+ * @brief Copy the current values into the other page and make it the valid one
+ * @note Order as in AN2594: RECEIVE, copy, erase the old page, VALID. A reset at any point
+ *       leaves a state CfgStore_Init can finish.
+ */
+static HAL_StatusTypeDef CfgStore_Transfer(void)
+{
+	uint32_t old_page = cfg.page;
+	uint32_t new_page = CfgStore_Other(old_page);
+	uint16_t slot = 0;
+
+	if (CFG_READ16(new_page) != CFG_PAGE_ERASED && CfgStore_Erase(new_page) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	if (CfgStore_Program(new_page, CFG_PAGE_RECEIVE) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	for (uint16_t key = 0; key < CFG_STORE_KEYS; key++)
+	{
+		if ((cfg.present & (1UL << key)) && CfgStore_WriteRecord(new_page, slot++, key, cfg.value[key]) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+	}
+	if (CfgStore_Erase(old_page) != HAL_OK || CfgStore_Program(new_page, CFG_PAGE_VALID) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	cfg.page = new_page;
+	cfg.next = slot;
+	cfg.dirty = 0;
+	cfg.stats.records = slot;
+	cfg.stats.transfers++;
+	return HAL_OK;
+}
+
+static HAL_StatusTypeDef CfgStore_Format(void)
+{
+	if (CfgStore_Erase(CFG_STORE_PAGE0) != HAL_OK || CfgStore_Erase(CFG_STORE_PAGE1) != HAL_OK ||
+		CfgStore_Program(CFG_STORE_PAGE0, CFG_PAGE_VALID) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	cfg.page = CFG_STORE_PAGE0;
+	cfg.next = 0;
+	cfg.present = 0;
+	cfg.stats.records = 0;
+	return HAL_OK;
+}
+
+/**
+ * @brief Find the valid page, finish an interrupted transfer and load every key into RAM
+ * @note Call once at startup, the scan time is kept in the statistics
+ * @return HAL_StatusTypeDef: HAL_OK, or HAL_ERROR if the flash could not be repaired or the
+ *         image reaches the store pages. Settings then stay in RAM only.
+ */
+HAL_StatusTypeDef CfgStore_Init(void)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+
+	memset(&cfg, 0, sizeof(cfg));
+	if (!CfgStore_Reserved())
+	{
+		cfg.stats.errors++;
+		return HAL_ERROR;		// Formatting would erase code
+	}
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	uint32_t start = DWT->CYCCNT;
+
+	uint16_t status0 = CFG_READ16(CFG_STORE_PAGE0);
+	uint16_t status1 = CFG_READ16(CFG_STORE_PAGE1);
+
+	HAL_FLASH_Unlock();
+	if (status0 == CFG_PAGE_VALID && status1 != CFG_PAGE_VALID)
+	{
+		CfgStore_Scan(CFG_STORE_PAGE0);
+		if (status1 != CFG_PAGE_ERASED)
+		{
+			status = CfgStore_Transfer();		// Transfer interrupted before the old page was erased
+		}
+	}
+	else if (status1 == CFG_PAGE_VALID && status0 != CFG_PAGE_VALID)
+	{
+		CfgStore_Scan(CFG_STORE_PAGE1);
+		if (status0 != CFG_PAGE_ERASED)
+		{
+			status = CfgStore_Transfer();
+		}
+	}
+	else if (status0 == CFG_PAGE_RECEIVE && status1 == CFG_PAGE_ERASED)
+	{
+		CfgStore_Scan(CFG_STORE_PAGE0);			// Copy complete, only the VALID mark is missing
+		status = CfgStore_Program(CFG_STORE_PAGE0, CFG_PAGE_VALID);
+	}
+	else if (status1 == CFG_PAGE_RECEIVE && status0 == CFG_PAGE_ERASED)
+	{
+		CfgStore_Scan(CFG_STORE_PAGE1);
+		status = CfgStore_Program(CFG_STORE_PAGE1, CFG_PAGE_VALID);
+	}
+	else
+	{
+		status = CfgStore_Format();				// Blank or corrupted
+	}
+	HAL_FLASH_Lock();
+
+	cfg.stats.scan_cycles = DWT->CYCCNT - start;
+	return status;
+}
+
+/**
+ * @brief Read a setting
+ * @param key: Setting key
+ * @param value: Receives the value if the key is set
+ * @return uint8_t: 1 if the key has a value, 0 otherwise
+ */
+uint8_t CfgStore_Get(uint16_t key, int16_t *value)
+{
+	if (key >= CFG_STORE_KEYS || !(cfg.present & (1UL << key)))
+	{
+		return 0;
+	}
+	*value = cfg.value[key];
+	return 1;
+}
+
+/**
+ * @brief Change a setting
+ * @note Only RAM is updated. The change reaches flash from CfgStore_Process once no other
+ *       change came for CFG_STORE_COMMIT_DELAY, so a burst of updates is one commit.
+ * @param key: Setting key
+ * @param value: New value
+ * @return HAL_StatusTypeDef: HAL_ERROR if the key is invalid, or if the store cannot write
+ *         (CfgStore_Init failed or a commit failed): the value is then used but not saved
+ */
+HAL_StatusTypeDef CfgStore_Set(uint16_t key, int16_t value)
+{
+	if (key >= CFG_STORE_KEYS)
+	{
+		return HAL_ERROR;
+	}
+	if (!(cfg.present & (1UL << key)) || cfg.value[key] != value)
+	{
+		cfg.value[key] = value;
+		cfg.present |= 1UL << key;
+		cfg.dirty |= 1UL << key;
+		cfg.changed_tick = HAL_GetTick();
+		cfg.stats.sets++;
+	}
+	return (cfg.page == 0 || cfg.failed) ? HAL_ERROR : HAL_OK;
+}
+
+/**
+ * @brief Latch a failed commit and lengthen the wait before the next automatic retry
+ */
+static void CfgStore_Fail(void)
+{
+	if (!cfg.failed)
+	{
+		cfg.retry_delay = CFG_STORE_RETRY_MIN;
+	}
+	else if (cfg.retry_delay < CFG_STORE_RETRY_MAX / 2)
+	{
+		cfg.retry_delay *= 2;
+	}
+	else
+	{
+		cfg.retry_delay = CFG_STORE_RETRY_MAX;
+	}
+	cfg.failed = 1;
+	cfg.failed_tick = HAL_GetTick();
+}
+
+/**
+ * @brief Write the pending changes now
+ * @note A key stays dirty until its record is programmed. After a failure the page may hold
+ *       a half-programmed slot, so the next commit rewrites every value into the other page.
+ * @return HAL_StatusTypeDef: HAL_OK if flash holds every value
+ */
+HAL_StatusTypeDef CfgStore_Flush(void)
+{
+	HAL_StatusTypeDef status = HAL_OK;
+
+	if (cfg.dirty == 0)
+	{
+		return HAL_OK;
+	}
+	if (cfg.page == 0)
+	{
+		CfgStore_Fail();
+		return HAL_ERROR;		// CfgStore_Init failed, no page may be written
+	}
+
+	uint16_t pending = 0;
+	for (uint32_t dirty = cfg.dirty; dirty != 0; dirty &= dirty - 1)
+	{
+		pending++;
+	}
+
+	HAL_FLASH_Unlock();
+	if (cfg.failed || pending > CFG_RECORD_SLOTS - cfg.next)
+	{
+		status = CfgStore_Transfer();		// Writes every value, the pending ones included
+	}
+	else
+	{
+		for (uint16_t key = 0; key < CFG_STORE_KEYS && status == HAL_OK; key++)
+		{
+			if (cfg.dirty & (1UL << key))
+			{
+				status = CfgStore_WriteRecord(cfg.page, cfg.next++, key, cfg.value[key]);
+				if (status == HAL_OK)
+				{
+					cfg.stats.records++;
+					cfg.dirty &= ~(1UL << key);
+				}
+			}
+		}
+	}
+	HAL_FLASH_Lock();
+
+	cfg.stats.commits++;
+	if (status != HAL_OK)
+	{
+		CfgStore_Fail();
+	}
+	else
+	{
+		cfg.failed = 0;
+	}
+	return status;
+}
+
+/**
+ * @brief Commit the pending changes once they have settled
+ * @note After a failure the commit is retried with a backoff, from CFG_STORE_RETRY_MIN up to
+ *       CFG_STORE_RETRY_MAX, so a bad page is not erased on every pass of the main loop.
+ * @param tick: Current system tick
+ */
+void CfgStore_Process(uint32_t tick)
+{
+	if (cfg.dirty == 0 || tick - cfg.changed_tick < CFG_STORE_COMMIT_DELAY)
+	{
+		return;
+	}
+	if (cfg.failed && tick - cfg.failed_tick < cfg.retry_delay)
+	{
+		return;
+	}
+	CfgStore_Flush();
+}
+
+/**
+ * @brief Read the store statistics
+ * @param stats: Destination for a snapshot of the counters
+ */
+void CfgStore_GetStats(cfg_store_stats_t *stats)
+{
+	*stats = cfg.stats;
+	stats->free_slots = CFG_RECORD_SLOTS - cfg.next;
+	stats->pending = cfg.dirty;
+	stats->failed = cfg.failed;
+	stats->retry_delay = cfg.failed ? cfg.retry_delay : 0;
+}
+
+/**
+ * @brief CLI command "cfg [flush]": state of the settings store, or commit the changes now
+ */
+void CfgStore_Command(char **argv, uint8_t arr_token)
+{
+	if (arr_token == 2 && !strcmp(argv[1], "flush"))
+	{
+		if (CfgStore_Flush() != HAL_OK)
+		{
+			PRINT_CLI("flush failed\n");
+			CLI_RPC_SetStatus(CLI_RPC_STATUS_ERROR);
+			return;
+		}
+		PRINT_CLI("flush ok\n");
+		return;
+	}
+	if (arr_token != 1)
+	{
+		PRINT_CLI("Too much argument\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
+		return;
+	}
+
+	cfg_store_stats_t stats;
+	CfgStore_GetStats(&stats);
+	PRINT_CLI("page 0x%08lx, records %u, free %u\n", (unsigned long) cfg.page, stats.records, stats.free_slots);
+	PRINT_CLI("commits %lu, writes %lu, transfers %lu, errors %lu\n", (unsigned long) stats.commits,
+			  (unsigned long) stats.writes, (unsigned long) stats.transfers, (unsigned long) stats.errors);
+	if (stats.failed)
+	{
+		uint32_t waited = HAL_GetTick() - cfg.failed_tick;
+		PRINT_CLI("FAILED, pending 0x%04lx, retry in %lu ms\n", (unsigned long) stats.pending,
+				  (unsigned long)((waited < stats.retry_delay) ? stats.retry_delay - waited : 0));
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_ERROR);
+	}
+	else
+	{
+		PRINT_CLI("ok, pending 0x%04lx\n", (unsigned long) stats.pending);
+	}
+}
+
+CLI_COMMAND(cfg, CfgStore_Command, "Trang thai luu cau hinh: cfg [flush]");
@@ -0,0 +1,386 @@
+#include "cli_edit.h"
+#include "uart.h"
+#include "print_cli.h"
+
+#include <string.h>
+
+#if (CLI_HISTORY_SIZE & (CLI_HISTORY_SIZE - 1)) != 0
+#error "CLI_HISTORY_SIZE must be a power of two"
+#endif
+
+#define HIST_MASK	(CLI_HISTORY_SIZE - 1)
+
+#define KEY_TAB		0x09
+#define KEY_BS		0x08
+#define KEY_DEL		0x7F
+#define KEY_ESC		0x1B
+
+static void CLI_Edit_Echo(const char *data, uint16_t len)
+{
+	PRINT_CLI_Write((const uint8_t*) data, len);
+}
+
+/**
+ * @brief Reprint the line from the cursor to the end and put the cursor back
+ * @param erase: Number of stale characters to blank after the end of the line
+ */
+static void CLI_Edit_RedrawTail(cli_t *cli, uint8_t erase)
+{
+	cli_edit_t *edit = &cli->edit;
+	uint8_t tail = cli->line_len - edit->cursor;
+
+	CLI_Edit_Echo((char*) &cli->line[edit->cursor], tail);
+	for (uint8_t i = 0; i < erase; i++)
+	{
+		CLI_Edit_Echo(" ", 1);
+	}
+	if (tail + erase > 0)
+	{
+		PRINT_CLI("\x1b[%uD", tail + erase);
+	}
+}
+
+/**
+ * @brief Replace the whole line being edited
+ */
+static void CLI_Edit_SetLine(cli_t *cli, const char *text, uint8_t len)
+{
+	cli_edit_t *edit = &cli->edit;
+	uint8_t erase = (cli->line_len > len) ? cli->line_len - len : 0;
+
+	if (edit->cursor > 0)
+	{
+		PRINT_CLI("\x1b[%uD", edit->cursor);
+	}
+	memcpy(cli->line, text, len);
+	memset(&cli->line[len], 0, sizeof(cli->line) - len);
+	cli->line_len = len;
+	edit->cursor = len;
+
+	CLI_Edit_Echo(text, len);
+	for (uint8_t i = 0; i < erase; i++)
+	{
+		CLI_Edit_Echo(" ", 1);
+	}
+	if (erase > 0)
+	{
+		PRINT_CLI("\x1b[%uD", erase);
+	}
+}
+
+/**
+ * @brief Copy a history entry into a buffer
+ * @param index: 1 for the newest entry, 2 for the one before...
+ * @return uint8_t: Length of the entry
+ */
+static uint8_t CLI_History_Get(cli_edit_t *edit, uint8_t index, char *out, uint8_t size)
+{
+	uint16_t pos = edit->hist_end;
+	uint16_t start = pos;
+	uint16_t end = pos;
+
+	for (uint8_t n = 0; n < index; n++)
+	{
+		end = pos - 1;		// NUL of the entry
+		start = end;
+		while (start != edit->hist_start && edit->history[(start - 1) & HIST_MASK] != '\0')
+		{
+			start--;
+		}
+		pos = start;
+	}
+
+	uint8_t len = 0;
+	for (uint16_t i = start; i != end && len < size - 1; i++)
+	{
+		out[len++] = edit->history[i & HIST_MASK];
+	}
+	return len;
+}
+
+static void CLI_History_Add(cli_edit_t *edit, const char *text, uint8_t len)
+{
+	uint16_t need = len + 1;
+	if (len == 0 || need > CLI_HISTORY_SIZE)
+	{
+		return;
+	}
+
+	// Skip a repeat of the newest entry
+	if (edit->hist_count > 0)
+	{
+		char newest[BUFFER_UART];
+		uint8_t newest_len = CLI_History_Get(edit, 1, newest, sizeof(newest));
+		if (newest_len == len && !memcmp(newest, text, len))
+		{
+			return;
+		}
+	}
+
+	// Drop the oldest entries until the new one fits
+	while ((uint16_t)(edit->hist_end - edit->hist_start) + need > CLI_HISTORY_SIZE)
+	{
+		while (edit->history[edit->hist_start++ & HIST_MASK] != '\0');
+		edit->hist_count--;
+	}
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		edit->history[edit->hist_end++ & HIST_MASK] = text[i];
+	}
+	edit->history[edit->hist_end++ & HIST_MASK] = '\0';
+	edit->hist_count++;
+}
+
+static void CLI_Edit_Browse(cli_t *cli, int8_t step)
+{
+	cli_edit_t *edit = &cli->edit;
+	int16_t index = edit->browse + step;
+
+	if (index < 0 || index > edit->hist_count)
+	{
+		return;
+	}
+	edit->browse = index;
+
+	char entry[BUFFER_UART];
+	uint8_t len = (index == 0) ? 0 : CLI_History_Get(edit, index, entry, sizeof(entry));
+	CLI_Edit_SetLine(cli, entry, len);
+}
+
+static void CLI_Edit_Insert(cli_t *cli, const char *text, uint8_t len)
+{
+	cli_edit_t *edit = &cli->edit;
+
+	if (cli->line_len + len > BUFFER_UART - 2)		// Keep room for the newline and the NUL
+	{
+		return;
+	}
+	memmove(&cli->line[edit->cursor + len], &cli->line[edit->cursor], cli->line_len - edit->cursor);
+	memcpy(&cli->line[edit->cursor], text, len);
+	cli->line_len += len;
+	CLI_Edit_Echo(text, len);
+	edit->cursor += len;
+	CLI_Edit_RedrawTail(cli, 0);
+}
+
+/**
+ * @brief Complete the command name under the cursor
+ * @note One match is completed, several matches are extended to their common
+ *       prefix and listed when nothing more can be added
+ */
+static void CLI_Edit_Complete(cli_t *cli)
+{
+	cli_edit_t *edit = &cli->edit;
+	const cli_command_t *commands = cli->commands;
+	const char *prefix = (const char*) cli->line;
+	uint8_t len = edit->cursor;
+
+	if (memchr(prefix, ' ', len) != NULL)
+	{
+		return;		// Only the command name is completed
+	}
+
+	uint16_t end;
+	uint16_t first = CLI_FindPrefix(cli, prefix, len, &end);
+	const char *match = NULL;
+	uint8_t common = 0;
+	uint8_t matches = 0;
+
+	for (uint16_t i = first; i < end; i++)
+	{
+		const char *name = commands[i].cmd_name;
+		if (strncmp(name, prefix, len) != 0)
+		{
+			continue;
+		}
+		if (match == NULL)
+		{
+			match = name;
+			common = strlen(name);
+		}
+		else
+		{
+			uint8_t n = len;
+			while (n < common && name[n] == match[n]) n++;
+			common = n;
+		}
+		matches++;
+	}
+
+	if (matches == 0)
+	{
+		return;
+	}
+	if (common > len)
+	{
+		CLI_Edit_Insert(cli, &match[len], common - len);
+		if (matches == 1)
+		{
+			CLI_Edit_Insert(cli, " ", 1);
+		}
+		return;
+	}
+	if (matches > 1)
+	{
+		PRINT_CLI("\r\n");
+		for (uint16_t i = first; i < end; i++)
+		{
+			if (!strncmp(commands[i].cmd_name, prefix, len))
+			{
+				PRINT_CLI("%s  ", commands[i].cmd_name);
+			}
+		}
+		PRINT_CLI("\r\n" CLI_PROMPT "%s", (char*) cli->line);
+		if (cli->line_len > edit->cursor)
+		{
+			PRINT_CLI("\x1b[%uD", cli->line_len - edit->cursor);
+		}
+	}
+}
+
+static void CLI_Edit_Enter(cli_t *cli)
+{
+	cli_edit_t *edit = &cli->edit;
+
+	CLI_Edit_Echo("\r\n", 2);
+	CLI_History_Add(edit, (char*) cli->line, cli->line_len);
+
+	cli->line[cli->line_len++] = '\n';
+	COMMAND_EXCUTE((char*) cli->line, cli->line_len);
+	memset(cli->line, 0, sizeof(cli->line));
+	cli->line_len = 0;
+	edit->cursor = 0;
+	edit->browse = 0;
+
+	if (edit->interactive && !cli->rpc.active)
+	{
+		PRINT_CLI(CLI_PROMPT);		// No text once "rpc" switched the console to frames
+	}
+}
+
+/**
+ * @brief Handle one received byte of an interactive console
+ * @note Called from CLI_Handle, understands backspace/DEL, arrow keys (ESC [ A/B/C/D), TAB and CR/LF
+ */
+void CLI_Edit_Byte(cli_t *cli, uint8_t data)
+{
+	cli_edit_t *edit = &cli->edit;
+
+	if (edit->esc_state == 1)
+	{
+		edit->esc_state = (data == '[') ? 2 : 0;
+		return;
+	}
+	if (edit->esc_state == 3)
+	{
+		edit->esc_state = (data == '~') ? 0 : 3;	// Skip "ESC [ n ~" keys (Home, Delete...)
+		return;
+	}
+	if (edit->esc_state == 2)
+	{
+		edit->esc_state = (data >= '0' && data <= '9') ? 3 : 0;
+		switch (data)
+		{
+			case 'A':
+				CLI_Edit_Browse(cli, 1);
+				break;
+			case 'B':
+				CLI_Edit_Browse(cli, -1);
+				break;
+			case 'C':
+				if (edit->cursor < cli->line_len)
+				{
+					CLI_Edit_Echo((char*) &cli->line[edit->cursor], 1);
+					edit->cursor++;
+				}
+				break;
+			case 'D':
+				if (edit->cursor > 0)
+				{
+					CLI_Edit_Echo("\b", 1);
+					edit->cursor--;
+				}
+				break;
+			default:
+				break;
+		}
+		return;
+	}
+
+	if (data == '\n' && edit->last_cr)
+	{
+		edit->last_cr = 0;
+		return;
+	}
+	edit->last_cr = (data == '\r');
+
+	switch (data)
+	{
+		case '\r':
+		case '\n':
+			CLI_Edit_Enter(cli);
+			break;
+		case KEY_ESC:
+			edit->esc_state = 1;
+			break;
+		case KEY_BS:
+		case KEY_DEL:
+			if (edit->cursor > 0)
+			{
+				memmove(&cli->line[edit->cursor - 1], &cli->line[edit->cursor], cli->line_len - edit->cursor);
+				cli->line_len--;
+				cli->line[cli->line_len] = '\0';
+				edit->cursor--;
+				CLI_Edit_Echo("\b", 1);
+				CLI_Edit_RedrawTail(cli, 1);
+			}
+			break;
+		case KEY_TAB:
+			CLI_Edit_Complete(cli);
+			break;
+		default:
+			if (data >= 0x20 && data < 0x7F)
+			{
+				char c = data;
+				CLI_Edit_Insert(cli, &c, 1);
+			}
+			break;
+	}
+}
+
+/**
+ * @brief Switch a console between the raw line mode used by machines and the interactive editor
+ * @note Meant to be called between lines, from a command or before the first byte arrives
+ * @param cli: Console
+ * @param enable: 1 for interactive, 0 for raw lines
+ */
+void CLI_SetInteractive(cli_t *cli, uint8_t enable)
+{
+	CLI_Stream_Reset(cli);		// Close a batch of the raw line mode before the editor takes over
+	cli->edit.interactive = enable;
+	cli->edit.cursor = 0;
+	cli->edit.esc_state = 0;
+	cli->edit.browse = 0;
+}
+
+/**
+ * @brief CLI command "term on|off": enable line editing, history and TAB completion
+ */
+void CLI_Term(char **argv, uint8_t arr_token)
+{
+	if (arr_token != 2)
+	{
+		PRINT_CLI("Too much argument\n");
+		return;
+	}
+	uint8_t was_interactive = cli_current->edit.interactive;
+	CLI_SetInteractive(cli_current, !strcmp(argv[1], "on"));
+	PRINT_CLI("Terminal %s\r\n", cli_current->edit.interactive ? "on" : "off");
+	if (cli_current->edit.interactive && !was_interactive)
+	{
+		PRINT_CLI(CLI_PROMPT);
+	}
+}
+
+CLI_COMMAND_FLAGS(term, CLI_Term, "Soan dong lenh, lich su va TAB: term on|off", CLI_CMD_NO_WATCH);
@@ -0,0 +1,98 @@
+#include "cli_perf.h"
+#include "uart.h"
+#include "print_cli.h"
+
+#include <string.h>
+
+#if CLI_PERF_ENABLE
+
+static void CLI_Perf_Add(cli_perf_phase_t *phase, uint32_t cycles, uint8_t first)
+{
+	phase->total += cycles;
+	if (first || cycles < phase->min)
+	{
+		phase->min = cycles;
+	}
+	if (first || cycles > phase->max)
+	{
+		phase->max = cycles;
+	}
+}
+
+/**
+ * @brief Account one execution of a command
+ * @note The handler time includes its output, the output time is taken out of it here
+ */
+void CLI_Perf_Record(cli_t *cli, const cli_command_t *command, uint32_t parse, uint32_t lookup,
+					 uint32_t handler, uint32_t output, uint32_t out_bytes)
+{
+	uint16_t index = command - cli->commands;
+	if (index >= CLI_PERF_MAX_COMMANDS)
+	{
+		return;
+	}
+
+	cli_perf_entry_t *entry = &cli->perf.entry[index];
+	uint8_t first = (entry->calls == 0);
+
+	entry->calls++;
+	entry->out_bytes += out_bytes;
+	CLI_Perf_Add(&entry->phase[CLI_PERF_PARSE], parse, first);
+	CLI_Perf_Add(&entry->phase[CLI_PERF_LOOKUP], lookup, first);
+	CLI_Perf_Add(&entry->phase[CLI_PERF_HANDLER], (handler > output) ? handler - output : 0, first);
+	CLI_Perf_Add(&entry->phase[CLI_PERF_OUTPUT], output, first);
+}
+
+/**
+ * @brief Print the profile of one command, one line per phase
+ * @note At most about 250 bytes, each line stays well below BUFFER_UART
+ */
+static void CLI_Perf_Print(cli_t *cli, uint16_t index)
+{
+	static const char *const phase_name[CLI_PERF_PHASES] = { "parse", "lookup", "handler", "output" };
+	cli_perf_entry_t *entry = &cli->perf.entry[index];
+
+	PRINT_CLI("%s calls %lu bytes %lu\n", cli->commands[index].cmd_name,
+			  (unsigned long) entry->calls, (unsigned long) entry->out_bytes);
+	for (uint8_t i = 0; i < CLI_PERF_PHASES; i++)
+	{
+		PRINT_CLI("  %-7s %lu/%lu/%lu\n", phase_name[i], (unsigned long)(entry->phase[i].total / entry->calls),
+				  (unsigned long) entry->phase[i].min, (unsigned long) entry->phase[i].max);
+	}
+}
+
+/**
+ * @brief Resumable command "perf [reset]"
+ * @note Prints one command per step once the TX ring has room, so a long table is never dropped
+ */
+cli_task_status_t CLI_Perf(cli_task_t *task)
+{
+	cli_t *cli = cli_current;
+
+	// var[0]: next table entry to print
+	CLI_PT_BEGIN(task);
+
+	if (task->arr_token == 2 && !strcmp(task->argv[1], "reset"))
+	{
+		memset(cli->perf.entry, 0, sizeof(cli->perf.entry));
+		PRINT_CLI("perf reset\n");
+		return CLI_TASK_DONE;
+	}
+
+	PRINT_CLI("avg/min/max cycles per call (per step for resumable commands)\n");
+	for (task->var[0] = 0; task->var[0] < cli->command_count && task->var[0] < CLI_PERF_MAX_COMMANDS; task->var[0]++)
+	{
+		if (cli->perf.entry[task->var[0]].calls == 0)
+		{
+			continue;
+		}
+		CLI_PT_WAIT_UNTIL(task, PRINT_CLI_TxFree(&cli->tx) >= 2 * BUFFER_UART);
+		CLI_Perf_Print(cli, task->var[0]);
+	}
+
+	CLI_PT_END(task);
+}
+
+CLI_COMMAND_STEP(perf, CLI_Perf, "Thong ke chu ky CPU cua tung lenh: perf [reset]");
+
+#endif
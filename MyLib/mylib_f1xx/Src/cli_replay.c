@@ -0,0 +1,167 @@
+#include "cli_replay.h"
+#include "uart.h"
+
+#include <string.h>
+
+typedef struct
+{
+	cli_replay_stats_t *stats;
+	const cli_replay_cfg_t *cfg;
+	uint64_t free_ns;		// Virtual time the CPU is done with the previous pass
+	uint32_t lines;			// '\n' queued since the previous pass
+	uint64_t first_ns;		// Arrival of the oldest and newest of them
+	uint64_t last_ns;
+	uint64_t sum_ns;		// Sum of their arrival times
+} cli_replay_ctx_t;
+
+/**
+ * @brief Start copying every byte received by a console into a buffer
+ * @note The copy is taken in the RX interrupt, before Ctrl-C and queue overflow are handled
+ * @param cli: Console to record
+ * @param buf: Destination buffer, recording stops silently when it is full
+ * @param size: Size of the buffer
+ */
+void CLI_Replay_RecordBegin(cli_t *cli, uint8_t *buf, uint16_t size)
+{
+	cli->record_buf = NULL;
+	cli->record_size = size;
+	cli->record_len = 0;
+	cli->record_buf = buf;
+}
+
+/**
+ * @brief Stop recording
+ * @return uint16_t: Number of bytes recorded, ready to be given to CLI_Replay_Run
+ */
+uint16_t CLI_Replay_RecordEnd(cli_t *cli)
+{
+	cli->record_buf = NULL;
+	return cli->record_len;
+}
+
+static uint16_t CLI_Replay_Sink(void *ctx, const uint8_t *data, uint16_t len)
+{
+	cli_replay_ctx_t *replay = (cli_replay_ctx_t*) ctx;
+	cli_replay_stats_t *stats = replay->stats;
+
+	stats->bytes_out += len;
+	if (replay->cfg->out_buf != NULL)
+	{
+		uint32_t room = replay->cfg->out_size - stats->out_len;
+		uint32_t n = (len < room) ? len : room;
+		memcpy(&replay->cfg->out_buf[stats->out_len], data, n);
+		stats->out_len += n;
+	}
+	return len;
+}
+
+/**
+ * @brief Run one pass of the console loop at virtual time now_ns
+ * @note The pass starts once the previous one is done and lasts its measured cycles at HCLK.
+ *       Every line queued before it completes when it ends.
+ */
+static void CLI_Replay_Poll(cli_t *cli, cli_replay_ctx_t *replay, uint64_t now_ns)
+{
+	cli_replay_stats_t *stats = replay->stats;
+
+	uint32_t start = CLI_CYCLES();
+	CLI_Handle(cli);
+	uint32_t cycles = CLI_CYCLES() - start;
+
+	uint64_t start_ns = (now_ns > replay->free_ns) ? now_ns : replay->free_ns;
+	replay->free_ns = start_ns + (uint64_t) cycles * 1000000000ULL / HAL_RCC_GetHCLKFreq();
+	stats->cycles += cycles;
+	if (replay->lines == 0)
+	{
+		return;
+	}
+
+	uint32_t latency_max = (uint32_t)((replay->free_ns - replay->first_ns) / 1000);
+	uint32_t latency_min = (uint32_t)((replay->free_ns - replay->last_ns) / 1000);
+	if (stats->commands == 0 || latency_min < stats->latency_min_us)
+	{
+		stats->latency_min_us = latency_min;
+	}
+	if (latency_max > stats->latency_max_us)
+	{
+		stats->latency_max_us = latency_max;
+	}
+	stats->latency_total_us += (replay->lines * replay->free_ns - replay->sum_ns) / 1000;
+	stats->commands += replay->lines;
+	replay->lines = 0;
+	replay->sum_ns = 0;
+}
+
+/**
+ * @brief Feed a recorded RX capture into a console as if it arrived on the UART
+ * @note Bytes go through the same queue as the RX interrupt, so a slow poll_us shows up as
+ *       queue depth and dropped bytes. The console output is counted and optionally copied
+ *       instead of being sent. Runs on the target and on Linux with the Host harness.
+ * @param cli: Console under test, initialised with CLI_Init
+ * @param capture: Bytes recorded with CLI_Replay_RecordBegin or taken from a UART log
+ * @param len: Number of bytes
+ * @param cfg: Line rate, poll period and output buffer
+ * @param stats: Results, cleared before the run
+ * @return HAL_StatusTypeDef: HAL_ERROR if cfg->baud is below CLI_REPLAY_BAUD_MIN
+ */
+HAL_StatusTypeDef CLI_Replay_Run(cli_t *cli, const uint8_t *capture, uint32_t len, const cli_replay_cfg_t *cfg,
+								 cli_replay_stats_t *stats)
+{
+	if (cfg->baud != 0 && cfg->baud < CLI_REPLAY_BAUD_MIN)
+	{
+		return HAL_ERROR;
+	}
+
+	cli_replay_ctx_t replay = { .stats = stats, .cfg = cfg };
+	CLI_SINK_FUN_T sink = cli->sink;
+	void *sink_ctx = cli->sink_ctx;
+	uint32_t dropped = cli->rx_dropped;
+
+	memset(stats, 0, sizeof(*stats));
+	CLI_CYCLES_ENABLE();
+	CLI_SetSink(cli, CLI_Replay_Sink, &replay);
+	cli->rx_peak = 0;
+
+	// Virtual time in ns, one byte is 10 bit times
+	uint64_t byte_ns = (cfg->baud != 0) ? 10000000000ULL / cfg->baud : 0;
+	uint64_t now_ns = 0;
+	uint64_t next_poll_ns = (uint64_t) cfg->poll_us * 1000;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		now_ns += byte_ns;
+		CLI_RxByte(cli, capture[i]);
+		if (capture[i] == '\n')
+		{
+			if (replay.lines++ == 0)
+			{
+				replay.first_ns = now_ns;
+			}
+			replay.last_ns = now_ns;
+			replay.sum_ns += now_ns;
+		}
+
+		// The loop cannot poll again while it is still busy with the previous pass
+		if (now_ns >= replay.free_ns && (cfg->poll_us == 0 || now_ns >= next_poll_ns))
+		{
+			CLI_Replay_Poll(cli, &replay, now_ns);
+			while (cfg->poll_us != 0 && next_poll_ns <= now_ns)
+			{
+				next_poll_ns += (uint64_t) cfg->poll_us * 1000;
+			}
+		}
+	}
+	CLI_Replay_Poll(cli, &replay, now_ns);
+
+	stats->bytes_in = len;
+	stats->rx_dropped = cli->rx_dropped - dropped;
+	stats->rx_peak = cli->rx_peak;
+	stats->wire_us = (uint32_t)(now_ns / 1000);
+	if (stats->cycles != 0)
+	{
+		stats->commands_per_s = (uint32_t)((uint64_t) stats->commands * HAL_RCC_GetHCLKFreq() / stats->cycles);
+	}
+
+	CLI_SetSink(cli, sink, sink_ctx);
+	return HAL_OK;
+}
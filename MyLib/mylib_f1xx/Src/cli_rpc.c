@@ -0,0 +1,260 @@
+#include "cli_rpc.h"
+#include "uart.h"
+#include "command_excute.h"
+#include "crc16.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Text command "rpc": switch the console to binary frames
+ */
+void CLI_RPC_Enter(char **argv, uint8_t arr_token)
+{
+	cli_rpc_t *rpc = &cli_current->rpc;
+	if (rpc->active)
+	{
+		return;
+	}
+	CLI_Stream_Reset(cli_current);		// The rest of the line is binary, end a batch here
+	PRINT_CLI("RPC mode\n");
+	rpc->len = 0;
+	rpc->active = 1;
+}
+
+uint8_t CLI_RPC_IsActive(cli_t *cli)
+{
+	return cli->rpc.active;
+}
+
+static void CLI_RPC_Dispatch(cli_t *cli);
+
+/**
+ * @brief Feed one received byte to the frame assembler, a complete frame is executed at once
+ * @note Called from CLI_Handle while the console is in RPC mode. The gap is measured between
+ *       arrival ticks, so a main loop held up by a long command does not split a frame that
+ *       came in without pause.
+ * @param tick: Low half of HAL_GetTick when the byte was received
+ */
+void CLI_RPC_RxByte(cli_t *cli, uint8_t data, uint16_t tick)
+{
+	cli_rpc_t *rpc = &cli->rpc;
+
+	if (rpc->need != 0 && (uint16_t)(tick - rpc->last_tick) > CLI_RPC_TIMEOUT)
+	{
+		rpc->need = 0;		// Stale partial frame
+	}
+	rpc->last_tick = tick;
+
+	if (rpc->need == 0)
+	{
+		if (data == CLI_RPC_SOF)
+		{
+			rpc->need = 1;	// Waiting for LEN
+			rpc->len = 0;
+		}
+		return;
+	}
+
+	if (rpc->len == 0)
+	{
+		if (data < 2 || data > CLI_RPC_FRAME_MAX)
+		{
+			rpc->need = 0;	// Not a frame
+			return;
+		}
+		rpc->need = data + 3;
+	}
+
+	rpc->frame[rpc->len++] = data;
+	if (rpc->len == rpc->need)
+	{
+		rpc->need = 0;
+		CLI_RPC_Dispatch(cli);
+
+		if (rpc->exit_pending)
+		{
+			rpc->exit_pending = 0;
+			rpc->active = 0;
+		}
+	}
+}
+
+/**
+ * @brief Set the status code of the reply to the command being dispatched
+ */
+void CLI_RPC_SetStatus(cli_rpc_status_t status)
+{
+	if (cli_current != NULL && cli_current->rpc.active)
+	{
+		cli_current->rpc.reply_status = status;
+	}
+}
+
+/**
+ * @brief Return a typed integer instead of the text printed by the handler
+ */
+void CLI_RPC_ReplyInt(int32_t value)
+{
+	if (cli_current != NULL && cli_current->rpc.active)
+	{
+		cli_current->rpc.reply_int = value;
+		cli_current->rpc.reply_int_set = 1;
+	}
+}
+
+static void CLI_RPC_Send(uint8_t seq, cli_rpc_status_t status, cli_rpc_type_t type, const uint8_t *payload, uint8_t len)
+{
+	uint8_t out[CLI_RPC_REPLY_MAX + 8];
+
+	out[0] = CLI_RPC_SOF;
+	out[1] = len + 3;
+	out[2] = seq;
+	out[3] = status;
+	out[4] = type;
+	if (len)
+	{
+		memcpy(&out[5], payload, len);		// Status-only replies pass payload NULL
+	}
+	uint16_t crc = Crc16_Modbus(&out[1], len + 4);
+	out[5 + len] = crc & 0xFF;
+	out[6 + len] = crc >> 8;
+
+	PRINT_CLI_Write(out, len + 7);
+}
+
+/**
+ * @brief Decode the typed arguments of a request into an argv array
+ * @return int8_t: Number of arguments, -1 if the encoding is invalid
+ */
+static int8_t CLI_RPC_DecodeArgs(const uint8_t *p, uint8_t len, char **argv, char *store, uint16_t store_size)
+{
+	uint8_t argc = 0;
+	uint16_t used = 0;
+
+	while (len > 0)
+	{
+		if (argc >= CLI_RPC_ARGS_MAX)
+		{
+			return -1;
+		}
+
+		int n;
+		if (p[0] == CLI_RPC_TYPE_INT32 && len >= 5)
+		{
+			int32_t value = (int32_t)((uint32_t)p[1] | ((uint32_t)p[2] << 8) |
+									  ((uint32_t)p[3] << 16) | ((uint32_t)p[4] << 24));
+			n = snprintf(&store[used], store_size - used, "%ld", (long) value);
+			p += 5;
+			len -= 5;
+		}
+		else if (p[0] == CLI_RPC_TYPE_STRING && len >= 2 && p[1] <= len - 2)
+		{
+			n = snprintf(&store[used], store_size - used, "%.*s", p[1], (const char*) &p[2]);
+			len -= p[1] + 2;
+			p += p[1] + 2;
+		}
+		else
+		{
+			return -1;
+		}
+
+		if (n < 0 || used + n >= store_size)
+		{
+			return -1;
+		}
+		argv[argc++] = &store[used];
+		used += n + 1;
+	}
+	return argc;
+}
+
+static void CLI_RPC_Dispatch(cli_t *cli)
+{
+	// frame: LEN SEQ CMD args... CRC_L CRC_H
+	cli_rpc_t *rpc = &cli->rpc;
+	const cli_command_t *commands = cli->commands;
+	uint8_t len = rpc->frame[0];
+	uint8_t seq = rpc->frame[1];
+	uint8_t cmd = rpc->frame[2];
+	uint16_t crc = rpc->frame[len + 1] | (rpc->frame[len + 2] << 8);
+
+	if (Crc16_Modbus(rpc->frame, len + 1) != crc)
+	{
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_BAD_CRC, CLI_RPC_TYPE_NONE, NULL, 0);
+		return;
+	}
+
+	CLI_PERF_MARK(t_parse);
+	char *argv[CLI_RPC_ARGS_MAX + 1];
+	char store[CLI_RPC_FRAME_MAX + CLI_RPC_ARGS_MAX * 8];
+	int8_t argc = CLI_RPC_DecodeArgs(&rpc->frame[3], len - 2, &argv[1], store, sizeof(store));
+	if (argc < 0)
+	{
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_BAD_ARGS, CLI_RPC_TYPE_NONE, NULL, 0);
+		return;
+	}
+
+	if (cmd == CLI_RPC_CMD_EXIT)
+	{
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_OK, CLI_RPC_TYPE_NONE, NULL, 0);
+		rpc->exit_pending = 1;
+		return;
+	}
+
+	if (cmd == CLI_RPC_CMD_LOOKUP)
+	{
+		const cli_command_t *found = (argc == 1) ? find_commmand(argv[1]) : NULL;
+		if (found == NULL)
+		{
+			CLI_RPC_Send(seq, CLI_RPC_STATUS_UNKNOWN_CMD, CLI_RPC_TYPE_NONE, NULL, 0);
+			return;
+		}
+		uint8_t id[4] = { (uint8_t)(found - commands), 0, 0, 0 };
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_OK, CLI_RPC_TYPE_INT32, id, sizeof(id));
+		return;
+	}
+
+	CLI_PERF_MARK(t_lookup);
+	if (cmd >= cli->command_count)
+	{
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_UNKNOWN_CMD, CLI_RPC_TYPE_NONE, NULL, 0);
+		return;
+	}
+	if (commands[cmd].func == NULL)
+	{
+		// Resumable commands stream text over several passes, only the text CLI runs them
+		CLI_RPC_Send(seq, CLI_RPC_STATUS_ERROR, CLI_RPC_TYPE_NONE, NULL, 0);
+		return;
+	}
+
+	uint8_t text[CLI_RPC_REPLY_MAX];
+	rpc->reply_status = CLI_RPC_STATUS_OK;
+	rpc->reply_int_set = 0;
+	argv[0] = commands[cmd].cmd_name;
+
+	CLI_PERF_MARK(t_handler);
+#if CLI_PERF_ENABLE
+	uint32_t out_cycles = cli->perf.out_cycles;
+	uint32_t out_bytes = cli->perf.out_bytes;
+#endif
+	PRINT_CLI_CaptureBegin(text, sizeof(text));
+	commands[cmd].func(argv, argc + 1);
+	uint16_t text_len = PRINT_CLI_CaptureEnd();
+	CLI_PERF_MARK(t_end);
+	CLI_PERF_RECORD(cli, &commands[cmd], CLI_PERF_SPAN(t_parse, t_lookup), CLI_PERF_SPAN(t_lookup, t_handler),
+					t_handler, t_end, out_cycles, out_bytes);
+
+	if (rpc->reply_int_set)
+	{
+		uint32_t v = (uint32_t) rpc->reply_int;
+		uint8_t value[4] = { v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, v >> 24 };
+		CLI_RPC_Send(seq, rpc->reply_status, CLI_RPC_TYPE_INT32, value, sizeof(value));
+	}
+	else
+	{
+		CLI_RPC_Send(seq, rpc->reply_status, text_len ? CLI_RPC_TYPE_STRING : CLI_RPC_TYPE_NONE, text, text_len);
+	}
+}
+
+CLI_COMMAND_FLAGS(rpc, CLI_RPC_Enter, "Chuyen sang che do RPC nhi phan", CLI_CMD_NO_WATCH);
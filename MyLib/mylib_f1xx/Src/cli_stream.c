@@ -0,0 +1,191 @@
+#include "cli_stream.h"
+#include "uart.h"
+#include "command_excute.h"
+
+static void CLI_Stream_Next(cli_t *cli)
+{
+	cli_stream_t *stream = &cli->stream;
+
+	stream->lo = 0;
+	stream->hi = cli->command_count;
+	stream->argc = 0;
+	stream->arg_len = 0;
+	stream->overflow = 0;
+}
+
+/**
+ * @brief Forget the partial command and start a new line
+ * @note A batch left open is closed and its reply sent, so its capture cannot swallow the
+ *       output of the input mode the console switches to
+ * @param cli: Console
+ */
+void CLI_Stream_Reset(cli_t *cli)
+{
+	cli_stream_t *stream = &cli->stream;
+
+	if (stream->batch)
+	{
+		cli_t *current = cli_current;
+		cli_current = cli;
+		stream->batch = 0;
+		COMMAND_BatchEnd(stream->batch_count);
+		cli_current = current;
+	}
+	CLI_Stream_Next(cli);
+}
+
+/**
+ * @brief Keep the commands whose next name character is c
+ * @note The candidates share their first pos characters, so in a table kept in strcmp order
+ *       the ones continuing with c are consecutive and found by binary search
+ */
+static void CLI_Stream_Narrow(cli_t *cli, uint8_t pos, uint8_t c)
+{
+	cli_stream_t *stream = &cli->stream;
+	const cli_command_t *commands = cli->commands;
+	uint16_t lo = stream->lo, hi = stream->hi;
+
+	while (lo < hi)
+	{
+		uint16_t mid = (lo + hi) / 2;
+		if ((uint8_t) commands[mid].cmd_name[pos] < c) lo = mid + 1;
+		else hi = mid;
+	}
+	uint16_t first = lo;
+
+	hi = stream->hi;
+	while (lo < hi)
+	{
+		uint16_t mid = (lo + hi) / 2;
+		if ((uint8_t) commands[mid].cmd_name[pos] <= c) lo = mid + 1;
+		else hi = mid;
+	}
+	stream->lo = first;
+	stream->hi = lo;
+}
+
+static void CLI_Stream_EndToken(cli_stream_t *stream)
+{
+	if (stream->arg_len == 0)
+	{
+		return;
+	}
+	stream->arg[stream->argc][stream->arg_len] = '\0';
+	stream->argc++;
+	stream->arg_len = 0;
+}
+
+static void CLI_Stream_Run(cli_t *cli)
+{
+	cli_stream_t *stream = &cli->stream;
+	const cli_command_t *command = NULL;
+
+	if (stream->overflow)
+	{
+		PRINT_CLI("Argument too long\n");
+		return;
+	}
+
+	CLI_PERF_MARK(t_lookup);
+	if (cli->commands_sorted)
+	{
+		// The name was matched while it arrived, only an exact match is left to check
+		uint8_t name_len = strlen(stream->arg[0]);
+		if (stream->lo < stream->hi && cli->commands[stream->lo].cmd_name[name_len] == '\0')
+		{
+			command = &cli->commands[stream->lo];
+		}
+	}
+	else
+	{
+		command = find_commmand(stream->arg[0]);
+	}
+	CLI_PERF_MARK(t_found);
+
+	if (command == NULL)
+	{
+		PRINT_CLI("Command not found\n");
+		return;
+	}
+
+	char *argv[CLI_MAX_ARGS];
+	for (uint8_t i = 0; i < stream->argc; i++)
+	{
+		argv[i] = stream->arg[i];
+	}
+	// Tokens are split as the bytes arrive, only the lookup is left to measure
+	COMMAND_Invoke(command, argv, stream->argc, 0, CLI_PERF_SPAN(t_lookup, t_found));
+}
+
+static void CLI_Stream_End(cli_t *cli, uint8_t separator)
+{
+	cli_stream_t *stream = &cli->stream;
+
+	CLI_Stream_EndToken(stream);
+	if (separator && !stream->batch)
+	{
+		stream->batch = 1;
+		stream->batch_count = 0;
+		COMMAND_BatchBegin();
+	}
+
+	if (stream->argc != 0)
+	{
+		if (stream->batch)
+		{
+			stream->batch_count++;
+		}
+		CLI_Stream_Run(cli);	// "rpc" or "term on" reset the parser and end the batch
+	}
+
+	if (!separator && stream->batch)
+	{
+		stream->batch = 0;
+		COMMAND_BatchEnd(stream->batch_count);
+	}
+	CLI_Stream_Next(cli);
+}
+
+/**
+ * @brief Parse one byte of the raw line mode
+ * @note The command name is resolved while it arrives and the tokens are stored in fixed
+ *       slots, so '\n' or CLI_BATCH_SEPARATOR invoke the handler at once and a line has no
+ *       length limit. Tokens beyond CLI_MAX_ARGS are ignored. Control bytes other than
+ *       TAB and CR are dropped.
+ * @param cli: Console
+ * @param data: Received byte
+ */
+void CLI_Stream_Byte(cli_t *cli, uint8_t data)
+{
+	cli_stream_t *stream = &cli->stream;
+
+	if (data == '\n' || data == CLI_BATCH_SEPARATOR)
+	{
+		CLI_Stream_End(cli, data == CLI_BATCH_SEPARATOR);
+		return;
+	}
+	if (data == ' ' || data == '\r' || data == '\t')
+	{
+		CLI_Stream_EndToken(stream);
+		return;
+	}
+	if (data < ' ' || data == 0x7F)
+	{
+		return;		// Control byte: NUL would also match the end of a name in CLI_Stream_Narrow
+	}
+	if (stream->argc >= CLI_MAX_ARGS)
+	{
+		return;
+	}
+	if (stream->arg_len >= CLI_STREAM_ARG_SIZE - 1)
+	{
+		stream->overflow = 1;
+		return;
+	}
+
+	if (stream->argc == 0 && cli->commands_sorted)
+	{
+		CLI_Stream_Narrow(cli, stream->arg_len, data);
+	}
+	stream->arg[stream->argc][stream->arg_len++] = data;
+}
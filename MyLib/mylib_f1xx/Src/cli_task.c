@@ -0,0 +1,117 @@
+#include "cli_task.h"
+#include "uart.h"
+#include "print_cli.h"
+
+#include <string.h>
+
+/**
+ * @brief Start a resumable command, its steps run from CLI_Task_Run
+ * @param cli: Console that received the command
+ * @param command: Command with a step function
+ * @param argv: Tokens of the command line, copied into the task
+ * @param arr_token: Number of tokens
+ */
+void CLI_Task_Start(cli_t *cli, const cli_command_t *command, char **argv, uint8_t arr_token)
+{
+	cli_task_runner_t *runner = &cli->task;
+	cli_task_t *task = &runner->task;
+
+	if (runner->command != NULL)
+	{
+		PRINT_CLI("Busy, Ctrl-C to cancel %s\n", runner->command->cmd_name);
+		return;
+	}
+
+	uint16_t used = 0;
+	task->arr_token = 0;
+	for (uint8_t i = 0; i < arr_token && i < CLI_TASK_ARGS_MAX; i++)
+	{
+		uint16_t len = strlen(argv[i]) + 1;
+		if (used + len > sizeof(task->args))
+		{
+			PRINT_CLI("Too much argument\n");
+			return;
+		}
+		memcpy(&task->args[used], argv[i], len);
+		task->argv[task->arr_token++] = &task->args[used];
+		used += len;
+	}
+
+	task->pt = 0;
+	memset(task->var, 0, sizeof(task->var));
+	runner->cancel = 0;
+	CLI_CYCLES_ENABLE();
+	runner->command = command;
+}
+
+/**
+ * @brief Give the running command of a console its time slice
+ * @note Called from CLI_Handle, steps are repeated until the budget is used up
+ * @param cli: Console being serviced
+ */
+void CLI_Task_Run(cli_t *cli)
+{
+	cli_task_runner_t *runner = &cli->task;
+
+	if (runner->command == NULL)
+	{
+		return;
+	}
+
+	if (runner->cancel)
+	{
+		runner->cancel = 0;
+		PRINT_CLI("^C %s cancelled\n", runner->command->cmd_name);
+		runner->command = NULL;
+		return;
+	}
+
+	uint32_t budget = runner->budget_us * (HAL_RCC_GetHCLKFreq() / 1000000);
+	uint32_t start = CLI_CYCLES();
+	do
+	{
+		const cli_command_t *command = runner->command;
+		CLI_PERF_MARK(t_step);
+#if CLI_PERF_ENABLE
+		uint32_t out_cycles = cli->perf.out_cycles;
+		uint32_t out_bytes = cli->perf.out_bytes;
+#endif
+		cli_task_status_t status = command->step(&runner->task);
+		CLI_PERF_MARK(t_end);
+		CLI_PERF_RECORD(cli, command, 0, 0, t_step, t_end, out_cycles, out_bytes);
+
+		if (status == CLI_TASK_DONE)
+		{
+			runner->command = NULL;
+			return;
+		}
+		if (status == CLI_TASK_WAITING)
+		{
+			return;
+		}
+	} while (CLI_CYCLES() - start < budget);
+}
+
+/**
+ * @brief Request the running command to stop before its next step
+ * @param cli: Console whose command is cancelled
+ */
+void CLI_Task_Cancel(cli_t *cli)
+{
+	cli->task.cancel = 1;
+}
+
+uint8_t CLI_Task_IsBusy(cli_t *cli)
+{
+	return cli->task.command != NULL;
+}
+
+/**
+ * @brief Set how long the running command may execute per main loop pass
+ * @param cli: Console to configure
+ * @param budget_us: Budget in microseconds, at least one step always runs
+ */
+void CLI_Task_SetBudget(cli_t *cli, uint32_t budget_us)
+{
+	cli->task.budget_us = budget_us;
+}
@@ -1,21 +1,18 @@
 #include "cli_types.h"
-#include "temperature_cli.h"
 
-cli_command_t list_cmd[] = {
-    {
-        .cmd_name = "getTemp",
-        .func = getTemp,
-        .help = "Cai dat nhiet do"
-    },
-    {
-        .cmd_name = "setTempMax",
-        .func = setTempMax,
-        .help = "Cai Nhiet Do Max"
-    },
-    {
-        .cmd_name = "setTempMin",
-        .func = setTempMin,
-        .help = "Cai Nhiet Do Min"
-    },
-    {NULL, NULL, NULL}
-};
+// Bounds of the .cli_cmd.* sections, defined by the linker script
+extern const cli_command_t __start_cli_cmd[];
+extern const cli_command_t __stop_cli_cmd[];
+
+// Sorts after every command name, ends the table for CLI_Init
+static const cli_command_t cli_cmd_end __attribute__((used, section(".cli_cmd.~"), aligned(4))) = { 0 };
+
+/**
+ * @brief Default command table: every CLI_COMMAND registration of the image
+ * @note The linker collects and sorts the entries in flash, this only returns its address
+ * @return const cli_command_t*: Table in strcmp order, terminated by an entry with a NULL name
+ */
+const cli_command_t* CLI_Commands(void)
+{
+	return __start_cli_cmd;
+}
@@ -0,0 +1,182 @@
+#include "cli_watch.h"
+#include "uart.h"
+#include "print_cli.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void CLI_Watch_List(cli_watch_t *watch)
+{
+	uint8_t active = 0;
+
+	for (uint8_t i = 0; i < CLI_WATCH_MAX; i++)
+	{
+		cli_watch_slot_t *w = &watch->slot[i];
+		if (w->command == NULL)
+		{
+			continue;
+		}
+		active++;
+		uint32_t avg = w->runs ? (uint32_t)(w->cycles_total / w->runs) : 0;
+		PRINT_CLI("watch %u: %s every %lu ms, runs %lu, cycles last %lu avg %lu max %lu\n",
+				  i, w->command->cmd_name, (unsigned long) w->period, (unsigned long) w->runs,
+				  (unsigned long) w->cycles_last, (unsigned long) avg, (unsigned long) w->cycles_max);
+	}
+	if (active == 0)
+	{
+		PRINT_CLI("No watch\n");
+	}
+}
+
+static void CLI_Watch_Stop(cli_watch_t *watch, char **argv, uint8_t arr_token)
+{
+	if (arr_token == 2)
+	{
+		CLI_Watch_StopAll(cli_current);
+		PRINT_CLI("All watches stopped\n");
+		return;
+	}
+
+	int id = atoi(argv[2]);
+	if (id < 0 || id >= CLI_WATCH_MAX || watch->slot[id].command == NULL)
+	{
+		PRINT_CLI("Watch Error\n");
+		return;
+	}
+	watch->slot[id].command = NULL;
+	PRINT_CLI("watch %d stopped\n", id);
+}
+
+/**
+ * @brief CLI command "watch"
+ * @note watch                         : list the active watches and their cost per run
+ *       watch <period_ms> <command...> : re-run a command every period_ms
+ *       watch stop [id]                : stop one watch, or all of them
+ */
+void CLI_Watch(char **argv, uint8_t arr_token)
+{
+	cli_watch_t *watch = &cli_current->watch;
+
+	if (arr_token == 1)
+	{
+		CLI_Watch_List(watch);
+		return;
+	}
+	if (!strcmp(argv[1], "stop"))
+	{
+		CLI_Watch_Stop(watch, argv, arr_token);
+		return;
+	}
+	if (arr_token < 3)
+	{
+		PRINT_CLI("Too much argument\n");
+		return;
+	}
+
+	int period = atoi(argv[1]);
+	if (period < CLI_WATCH_MIN_PERIOD)
+	{
+		PRINT_CLI("Period Error\n");
+		return;
+	}
+
+	// Commands flagged at registration (rpc, term, watch) must not run from a timer
+	const cli_command_t *command = find_commmand(argv[2]);
+	if (command == NULL || command->func == NULL || (command->flags & CLI_CMD_NO_WATCH))
+	{
+		PRINT_CLI("Command not found\n");
+		return;
+	}
+
+	cli_watch_slot_t *w = NULL;
+	uint8_t id;
+	for (id = 0; id < CLI_WATCH_MAX; id++)
+	{
+		if (watch->slot[id].command == NULL)
+		{
+			w = &watch->slot[id];
+			break;
+		}
+	}
+	if (w == NULL)
+	{
+		PRINT_CLI("Too many watches\n");
+		return;
+	}
+
+	// Keep a private copy of the arguments, argv points into the line buffer
+	uint16_t used = 0;
+	w->arr_token = 0;
+	for (uint8_t i = 2; i < arr_token && w->arr_token < CLI_MAX_ARGS; i++)
+	{
+		uint16_t len = strlen(argv[i]) + 1;
+		if (used + len > sizeof(w->args))
+		{
+			PRINT_CLI("Too much argument\n");
+			return;
+		}
+		memcpy(&w->args[used], argv[i], len);
+		w->argv[w->arr_token++] = &w->args[used];
+		used += len;
+	}
+
+	CLI_CYCLES_ENABLE();
+	w->period = period;
+	w->next_tick = HAL_GetTick() + period;
+	w->runs = 0;
+	w->cycles_last = 0;
+	w->cycles_max = 0;
+	w->cycles_total = 0;
+	w->command = command;
+
+	PRINT_CLI("watch %u: %s every %d ms\n", id, command->cmd_name, period);
+}
+
+/**
+ * @brief Run the watches of a console whose period has elapsed
+ * @param cli: Console being serviced
+ * @param current_tick: Current system tick (e.g., HAL_GetTick())
+ */
+void CLI_Watch_Process(cli_t *cli, uint32_t current_tick)
+{
+	for (uint8_t i = 0; i < CLI_WATCH_MAX; i++)
+	{
+		cli_watch_slot_t *w = &cli->watch.slot[i];
+		if (w->command == NULL || (int32_t)(current_tick - w->next_tick) < 0)
+		{
+			continue;
+		}
+
+		uint32_t start = CLI_CYCLES();
+		w->command->func(w->argv, w->arr_token);
+		uint32_t cycles = CLI_CYCLES() - start;
+
+		w->runs++;
+		w->cycles_last = cycles;
+		w->cycles_total += cycles;
+		if (cycles > w->cycles_max)
+		{
+			w->cycles_max = cycles;
+		}
+
+		w->next_tick += w->period;
+		if ((int32_t)(current_tick - w->next_tick) >= 0)
+		{
+			w->next_tick = current_tick + w->period;	// Fell behind, do not burst to catch up
+		}
+	}
+}
+
+/**
+ * @brief Cancel every active watch of a console
+ * @param cli: Console whose watches stop
+ */
+void CLI_Watch_StopAll(cli_t *cli)
+{
+	for (uint8_t i = 0; i < CLI_WATCH_MAX; i++)
+	{
+		cli->watch.slot[i].command = NULL;
+	}
+}
+
+CLI_COMMAND_FLAGS(watch, CLI_Watch, "Lap lai lenh theo chu ky: watch <ms> <lenh...> | watch stop [id]", CLI_CMD_NO_WATCH);
@@ -1,38 +1,133 @@
 #include "command_excute.h"
 #include "temperature_cli.h"
 #include "cli_types.h"
+#include "cli_task.h"
 
-extern cli_command_t list_cmd[];
+#if CLI_BATCH_REPLY_MAX > PRINT_CLI_TX_SIZE
+#error "CLI_BATCH_REPLY_MAX must fit in PRINT_CLI_TX_SIZE, a batch reply is written to the ring at once"
+#endif
 
-cli_command_t* find_commmand(char* cmd)
+/**
+ * @brief Locate the commands whose name starts with a prefix
+ * @note A table kept in strcmp order behaves like a prefix trie: the matches are consecutive
+ *       and their range is found by binary search. An unsorted table returns the whole
+ *       table, the caller filters it with strncmp.
+ * @param cli: Console whose table is searched
+ * @param prefix: Start of the command name
+ * @param len: Length of the prefix
+ * @param end: Receives the index after the last candidate
+ * @return uint16_t: Index of the first candidate
+ */
+uint16_t CLI_FindPrefix(const cli_t *cli, const char *prefix, uint8_t len, uint16_t *end)
 {
-	for (uint8_t i = 0; list_cmd[i].cmd_name != NULL; i++) {
-		if (!strcmp(list_cmd[i].cmd_name , cmd))
+	const cli_command_t *commands = cli->commands;
+
+	if (!cli->commands_sorted)
+	{
+		*end = cli->command_count;
+		return 0;
+	}
+
+	// Lower bound of the prefix
+	uint16_t lo = 0, hi = cli->command_count;
+	while (lo < hi)
+	{
+		uint16_t mid = (lo + hi) / 2;
+		if (strncmp(commands[mid].cmd_name, prefix, len) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	uint16_t first = lo;
+
+	// Upper bound of the prefix
+	hi = cli->command_count;
+	while (lo < hi)
+	{
+		uint16_t mid = (lo + hi) / 2;
+		if (strncmp(commands[mid].cmd_name, prefix, len) <= 0) lo = mid + 1;
+		else hi = mid;
+	}
+	*end = lo;
+	return first;
+}
+
+const cli_command_t* find_commmand(char* cmd)
+{
+	const cli_command_t *commands = cli_current->commands;
+	uint16_t end;
+
+	for (uint16_t i = CLI_FindPrefix(cli_current, cmd, strlen(cmd), &end); i < end; i++) {
+		if (!strcmp(commands[i].cmd_name , cmd))
 		{
-			return &list_cmd[i];
+			return &commands[i];
 		}
 	}
 	return NULL;
 }
 
-void COMMAND_EXCUTE(char *buff, uint8_t argc)
+/**
+ * @brief Run a resolved command on the current console
+ * @note Resumable commands are handed to the task runner, the others run to completion here
+ * @param command: Entry of the command table
+ * @param argv: Tokens, argv[0] is the command name
+ * @param argc: Number of tokens
+ * @param parse: Cycles spent splitting the tokens, for the profile
+ * @param lookup: Cycles spent finding the command, for the profile
+ */
+void COMMAND_Invoke(const cli_command_t *command, char **argv, uint8_t argc, uint32_t parse, uint32_t lookup)
 {
-	char *argv[10];
-	uint8_t arr_token = 0;
-
-	char *token = strtok(buff, " ");
-	while (token != NULL)
+	if (command -> step != NULL)
 	{
-		argv[arr_token++] = token;
-	    token = strtok(NULL, " ");
+		CLI_Task_Start(cli_current, command, argv, argc);
+		return;
 	}
-	cli_command_t *command = find_commmand(argv[0]);
-	if (command == NULL)
-	{
-		PRINT_CLI("Command not found\n");
-	}
-	else
+
+	CLI_PERF_MARK(t_handler);
+#if CLI_PERF_ENABLE
+	uint32_t out_cycles = cli_current->perf.out_cycles;
+	uint32_t out_bytes = cli_current->perf.out_bytes;
+#endif
+	command -> func(argv, argc);
+	CLI_PERF_MARK(t_end);
+	CLI_PERF_RECORD(cli_current, command, parse, lookup, t_handler, t_end, out_cycles, out_bytes);
+	(void) parse;
+	(void) lookup;
+}
+
+/**
+ * @brief Start collecting the output of a batch in the buffer of the current console
+ */
+void COMMAND_BatchBegin(void)
+{
+	PRINT_CLI_CaptureBegin(cli_current->batch_reply, sizeof(cli_current->batch_reply) - 16);	// Keep room for the trailer
+}
+
+/**
+ * @brief Send the collected output of a batch as one reply terminated by "END <count>\n"
+ * @param count: Number of commands the batch ran
+ */
+void COMMAND_BatchEnd(uint8_t count)
+{
+	uint8_t *reply = cli_current->batch_reply;
+	uint16_t len = PRINT_CLI_CaptureEnd();
+
+	len += snprintf((char*) &reply[len], CLI_BATCH_REPLY_MAX - len, "END %u\n", count);
+	PRINT_CLI_Write(reply, len);
+}
+
+/**
+ * @brief Execute a line typed in interactive mode
+ * @note The line goes through the raw mode parser, so batches separated by
+ *       CLI_BATCH_SEPARATOR behave the same in both modes. Feeding stops once a command
+ *       switches the console to RPC: what follows on the line is not a binary frame.
+ * @param buff: Edited line, terminated by '\n'
+ * @param argc: Length of the line
+ */
+void COMMAND_EXCUTE(char *buff, uint8_t argc)
+{
+	cli_t *cli = cli_current;
+
+	for (uint8_t i = 0; i < argc && !cli->rpc.active; i++)
 	{
-		command -> func(argv, arr_token);
+		CLI_Stream_Byte(cli, (uint8_t) buff[i]);
 	}
 }
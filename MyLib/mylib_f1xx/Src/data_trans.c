@@ -589,9 +589,10 @@ DataTransError DataTrans_Printf(DataTrans_t* dt, uint32_t timeout, const char* f
 
 /**
  * @brief Xử lý hoàn thành truyền DMA
+ * @note Được gọi từ HAL_UART_TxCpltCallback trong uart.c
  * @param huart: UART handle
  */
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+void DataTrans_HandleTxComplete(UART_HandleTypeDef *huart) {
     // Tìm đối tượng DataTrans tương ứng
     for (int i = 0; i < MAX_UART_HANDLERS; i++) {
         if (uart_mapping[i].huart == huart) {
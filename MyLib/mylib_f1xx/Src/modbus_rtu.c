@@ -0,0 +1,359 @@
+#include "modbus_rtu.h"
+#include "temperature.h"
+#include "temp_alarm.h"
+#include "cfg_store.h"
+#include "crc16.h"
+#include "uart.h"
+
+#include <string.h>
+
+static modbus_t *modbus_ports[MODBUS_PORT_MAX];
+
+/**
+ * @brief Start a Modbus RTU slave on a UART
+ * @note htim must count at 1 MHz with its update interrupt enabled in the NVIC, and the
+ *       application must call Modbus_TimerElapsed from HAL_TIM_PeriodElapsedCallback.
+ *       Its period is set here to 3.5 character times (1750 µs above 19200 baud).
+ * @param mb: Slave object, owned by the caller
+ * @param huart: UART connected to the bus, without a console on it
+ * @param htim: Timer measuring the silence between frames
+ * @param address: Slave address 1..247
+ */
+void Modbus_Init(modbus_t *mb, UART_HandleTypeDef *huart, TIM_HandleTypeDef *htim, uint8_t address)
+{
+	memset(mb, 0, sizeof(*mb));
+	mb->huart = huart;
+	mb->htim = htim;
+	mb->address = address;
+
+	// 11 bits per character: start, 8 data, parity or second stop, stop
+	uint32_t baud = huart->Init.BaudRate;
+	uint32_t t35 = (baud > 19200) ? 1750 : (35 * 11 * 100000UL) / baud;
+	__HAL_TIM_SET_AUTORELOAD(htim, t35 - 1);
+
+	for (uint8_t i = 0; i < MODBUS_PORT_MAX; i++)
+	{
+		if (modbus_ports[i] == NULL || modbus_ports[i]->huart == huart)
+		{
+			modbus_ports[i] = mb;
+			break;
+		}
+	}
+	UART_SetRxHook(Modbus_HandleRx);
+	HAL_UART_Receive_IT(huart, &mb->data_rx, sizeof(mb->data_rx));
+}
+
+/**
+ * @brief Expose a servo in the holding registers
+ * @param index: Servo number 0..MODBUS_SERVOS-1
+ */
+void Modbus_AttachServo(modbus_t *mb, uint8_t index, Servo *sv)
+{
+	if (index < MODBUS_SERVOS)
+	{
+		mb->servo[index] = sv;
+	}
+}
+
+/**
+ * @brief Receive interrupt of a Modbus UART
+ * @note Registered with UART_SetRxHook, called for the UARTs without a console
+ * @return uint8_t: 1 if the UART belongs to a Modbus slave
+ */
+uint8_t Modbus_HandleRx(UART_HandleTypeDef *huart)
+{
+	modbus_t *mb = NULL;
+	for (uint8_t i = 0; i < MODBUS_PORT_MAX && mb == NULL; i++)
+	{
+		if (modbus_ports[i] != NULL && modbus_ports[i]->huart == huart)
+		{
+			mb = modbus_ports[i];
+		}
+	}
+	if (mb == NULL)
+	{
+		return 0;
+	}
+
+	uint8_t data = mb->data_rx;
+	HAL_UART_Receive_IT(huart, &mb->data_rx, sizeof(mb->data_rx));
+
+	if (mb->frame_ready || mb->rx_len >= MODBUS_FRAME_MAX)
+	{
+		mb->stats.overruns++;
+		return 1;
+	}
+	mb->rx[mb->rx_len++] = data;
+
+	// Every byte restarts the silence measurement
+	__HAL_TIM_SET_COUNTER(mb->htim, 0);
+	if (mb->rx_len == 1)
+	{
+		__HAL_TIM_CLEAR_IT(mb->htim, TIM_IT_UPDATE);
+		HAL_TIM_Base_Start_IT(mb->htim);
+	}
+	return 1;
+}
+
+/**
+ * @brief End of frame: no byte for 3.5 character times
+ * @note Call from HAL_TIM_PeriodElapsedCallback, other timers are ignored
+ */
+void Modbus_TimerElapsed(TIM_HandleTypeDef *htim)
+{
+	for (uint8_t i = 0; i < MODBUS_PORT_MAX; i++)
+	{
+		modbus_t *mb = modbus_ports[i];
+		if (mb != NULL && mb->htim == htim)
+		{
+			HAL_TIM_Base_Stop_IT(htim);
+			mb->frame_ready = 1;
+		}
+	}
+}
+
+static uint8_t Modbus_ReadInput(uint16_t reg, uint16_t *value)
+{
+	if (reg < MODBUS_INPUT_ADC)
+	{
+		int16_t temp;
+		*value = Temperature_Get(reg - MODBUS_INPUT_TEMP, &temp, NULL) ? (uint16_t) temp : MODBUS_NO_DATA;
+	}
+	else if (reg < MODBUS_INPUT_ALARM)
+	{
+		*value = Temperature_GetRaw(reg - MODBUS_INPUT_ADC);
+	}
+	else if (reg < MODBUS_INPUT_COUNT)
+	{
+		*value = TempAlarm_Get(reg - MODBUS_INPUT_ALARM)->state;
+	}
+	else
+	{
+		return MODBUS_EX_ILLEGAL_ADDRESS;
+	}
+	return 0;
+}
+
+static uint8_t Modbus_ReadHolding(modbus_t *mb, uint16_t reg, uint16_t *value)
+{
+	int16_t limit = 0;
+
+	if (reg < MODBUS_HOLD_SERVO)
+	{
+		CfgStore_Get(CFG_KEY_TEMP_MAX + reg, &limit);		// Min keys follow the max keys
+		*value = (uint16_t) limit;
+	}
+	else if (reg < MODBUS_HOLD_COUNT)
+	{
+		Servo *sv = mb->servo[reg - MODBUS_HOLD_SERVO];
+		*value = (sv != NULL) ? SERVO_READ(sv) : 0;
+	}
+	else
+	{
+		return MODBUS_EX_ILLEGAL_ADDRESS;
+	}
+	return 0;
+}
+
+/**
+ * @brief Check a holding register write, same limits as the CLI commands
+ * @param values: Register values of a write multiple request (big endian), NULL for a single
+ *        write. A temperature limit is then compared with the other limit of its channel
+ *        from the request when it writes both.
+ * @param first: First register of values
+ * @param count: Registers in values
+ */
+static uint8_t Modbus_CheckHolding(modbus_t *mb, uint16_t reg, uint16_t value, const uint8_t *values,
+								   uint16_t first, uint16_t count)
+{
+	if (reg < MODBUS_HOLD_SERVO)
+	{
+		uint8_t is_min = (reg >= MODBUS_HOLD_TEMP_MIN);
+		uint8_t channel = reg - (is_min ? MODBUS_HOLD_TEMP_MIN : MODBUS_HOLD_TEMP_MAX);
+		uint16_t pair = (is_min ? MODBUS_HOLD_TEMP_MAX : MODBUS_HOLD_TEMP_MIN) + channel;
+		int16_t other;
+		const int16_t *p_other = NULL;
+
+		if (values != NULL && pair >= first && pair - first < count)
+		{
+			other = (int16_t)((values[(pair - first) * 2] << 8) | values[(pair - first) * 2 + 1]);
+			p_other = &other;
+		}
+		return TempAlarm_CheckLimit(channel, is_min, (int16_t) value, p_other) ? 0 : MODBUS_EX_ILLEGAL_VALUE;
+	}
+	if (reg < MODBUS_HOLD_COUNT)
+	{
+		return (mb->servo[reg - MODBUS_HOLD_SERVO] == NULL) ? MODBUS_EX_ILLEGAL_ADDRESS :
+			   (value > 180) ? MODBUS_EX_ILLEGAL_VALUE : 0;
+	}
+	return MODBUS_EX_ILLEGAL_ADDRESS;
+}
+
+/**
+ * @return uint8_t: MODBUS_EX_DEVICE_FAILURE if a limit could not be saved, 0 otherwise
+ */
+static uint8_t Modbus_WriteHolding(modbus_t *mb, uint16_t reg, uint16_t value)
+{
+	if (reg < MODBUS_HOLD_SERVO)
+	{
+		return (CfgStore_Set(CFG_KEY_TEMP_MAX + reg, (int16_t) value) != HAL_OK) ? MODBUS_EX_DEVICE_FAILURE : 0;
+	}
+	SERVO_WRITE(mb->servo[reg - MODBUS_HOLD_SERVO], value);
+	return 0;
+}
+
+/**
+ * @brief Execute the PDU of a request
+ * @return uint16_t: Length of the reply PDU written to tx[1..], 0 with *exception set on error
+ */
+static uint16_t Modbus_Execute(modbus_t *mb, const uint8_t *req, uint16_t len, uint8_t *exception)
+{
+	uint8_t fc = req[0];
+	uint8_t *reply = &mb->tx[1];
+	uint16_t reg = (req[1] << 8) | req[2];
+	uint16_t count = (req[3] << 8) | req[4];
+
+	reply[0] = fc;
+	switch (fc)
+	{
+		case MODBUS_FC_READ_HOLDING:
+		case MODBUS_FC_READ_INPUT:
+			if (len != 5)
+			{
+				break;
+			}
+			if (count == 0 || count > 125)
+			{
+				*exception = MODBUS_EX_ILLEGAL_VALUE;
+				return 0;
+			}
+			reply[1] = count * 2;
+			for (uint16_t i = 0; i < count; i++)
+			{
+				uint16_t value;
+				*exception = (fc == MODBUS_FC_READ_INPUT) ? Modbus_ReadInput(reg + i, &value) :
+															Modbus_ReadHolding(mb, reg + i, &value);
+				if (*exception)
+				{
+					return 0;
+				}
+				reply[2 + i * 2] = value >> 8;
+				reply[3 + i * 2] = value & 0xFF;
+			}
+			return 2 + count * 2;
+
+		case MODBUS_FC_WRITE_SINGLE:
+			if (len != 5)
+			{
+				break;
+			}
+			// count holds the value for this function
+			if ((*exception = Modbus_CheckHolding(mb, reg, count, NULL, 0, 0)) != 0 ||
+				(*exception = Modbus_WriteHolding(mb, reg, count)) != 0)
+			{
+				return 0;
+			}
+			memcpy(&reply[1], &req[1], 4);		// Echo of the request
+			return 5;
+
+		case MODBUS_FC_WRITE_MULTIPLE:
+			if (len < 6 || len != 6 + req[5])
+			{
+				break;
+			}
+			if (count == 0 || count > 123 || req[5] != count * 2)
+			{
+				*exception = MODBUS_EX_ILLEGAL_VALUE;
+				return 0;
+			}
+			// Validate everything first so a rejected request changes nothing
+			for (uint16_t i = 0; i < count; i++)
+			{
+				if ((*exception = Modbus_CheckHolding(mb, reg + i, (req[6 + i * 2] << 8) | req[7 + i * 2],
+													  &req[6], reg, count)) != 0)
+				{
+					return 0;
+				}
+			}
+			for (uint16_t i = 0; i < count; i++)
+			{
+				uint8_t failure = Modbus_WriteHolding(mb, reg + i, (req[6 + i * 2] << 8) | req[7 + i * 2]);
+				if (failure)
+				{
+					*exception = failure;		// Every register is applied, report it at the end
+				}
+			}
+			if (*exception)
+			{
+				return 0;
+			}
+			memcpy(&reply[1], &req[1], 4);
+			return 5;
+
+		default:
+			*exception = MODBUS_EX_ILLEGAL_FUNCTION;
+			return 0;
+	}
+
+	*exception = MODBUS_EX_ILLEGAL_VALUE;		// Malformed request
+	return 0;
+}
+
+/**
+ * @brief Answer the frame received, if any
+ * @note Call from the main loop. Running here rather than in the timer interrupt keeps
+ *       register writes in the same context as the CLI commands that change them.
+ */
+void Modbus_Process(modbus_t *mb)
+{
+	if (!mb->frame_ready)
+	{
+		return;
+	}
+
+	uint16_t len = mb->rx_len;
+	uint8_t *frame = mb->rx;
+	uint8_t broadcast = (frame[0] == 0);
+
+	if (len < 4 || (frame[0] != mb->address && !broadcast))
+	{
+		mb->stats.ignored++;
+	}
+	else if (Crc16_Modbus(frame, len - 2) != (frame[len - 2] | (frame[len - 1] << 8)))
+	{
+		mb->stats.crc_errors++;
+	}
+	else
+	{
+		uint8_t exception = 0;
+		uint16_t reply_len = Modbus_Execute(mb, &frame[1], len - 3, &exception);
+
+		if (exception)
+		{
+			mb->tx[1] = frame[1] | 0x80;
+			mb->tx[2] = exception;
+			reply_len = 2;
+			mb->stats.exceptions++;
+		}
+		if (!broadcast)
+		{
+			mb->tx[0] = mb->address;
+			uint16_t crc = Crc16_Modbus(mb->tx, reply_len + 1);
+			mb->tx[reply_len + 1] = crc & 0xFF;
+			mb->tx[reply_len + 2] = crc >> 8;
+			if (HAL_UART_Transmit_IT(mb->huart, mb->tx, reply_len + 3) == HAL_OK)
+			{
+				mb->stats.frames++;
+			}
+			else
+			{
+				// Previous reply still going out or UART in error: drop this one, keep listening
+				mb->stats.tx_errors++;
+				HAL_UART_Receive_IT(mb->huart, &mb->data_rx, sizeof(mb->data_rx));
+			}
+		}
+	}
+
+	mb->rx_len = 0;
+	mb->frame_ready = 0;
+}
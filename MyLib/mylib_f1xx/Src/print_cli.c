@@ -1,13 +1,240 @@
 #include "print_cli.h"
+#include "uart.h"
+
+#include <string.h>
+
+#if (PRINT_CLI_TX_SIZE & (PRINT_CLI_TX_SIZE - 1)) != 0
+#error "PRINT_CLI_TX_SIZE must be a power of two"
+#endif
+
+#define TX_MASK		(PRINT_CLI_TX_SIZE - 1)
+
+/**
+ * @brief Start sending the next contiguous chunk of the ring if the UART is idle
+ * @note Must be called with interrupts disabled or from the TX complete interrupt
+ */
+static void PRINT_CLI_Kick(print_cli_tx_t *tx)
+{
+	uint16_t head = tx->head;
+	uint16_t tail = tx->tail;
+
+	if (tx->len != 0 || head == tail)
+	{
+		return;
+	}
+
+	uint16_t start = tail & TX_MASK;
+	uint16_t len = (uint16_t)(head - tail);
+	if (start + len > PRINT_CLI_TX_SIZE)
+	{
+		len = PRINT_CLI_TX_SIZE - start;	// Send up to the end of the ring, the rest follows
+	}
+
+	tx->len = len;
+#if PRINT_CLI_USE_DMA
+	if (HAL_UART_Transmit_DMA(tx->huart, &tx->ring[start], len) != HAL_OK)
+#else
+	if (HAL_UART_Transmit_IT(tx->huart, &tx->ring[start], len) != HAL_OK)
+#endif
+	{
+		tx->len = 0;		// UART busy with another transfer, retried on its TX complete or by CLI_Handle
+	}
+}
+
+/**
+ * @brief Prepare the TX ring of a console
+ * @param tx: TX state to initialise
+ * @param huart: UART that drains the ring
+ */
+void PRINT_CLI_TxInit(print_cli_tx_t *tx, UART_HandleTypeDef *huart)
+{
+	memset(tx, 0, sizeof(*tx));
+	tx->huart = huart;
+}
+
+/**
+ * @brief Append raw bytes to a TX ring without blocking
+ * @note Default output sink of a console
+ * @param ctx: print_cli_tx_t of the console
+ * @param data: Bytes to send
+ * @param len: Number of bytes
+ * @return uint16_t: Number of bytes queued, 0 if the ring had no room for all of them
+ */
+uint16_t PRINT_CLI_TxWrite(void *ctx, const uint8_t *data, uint16_t len)
+{
+	print_cli_tx_t *tx = (print_cli_tx_t*) ctx;
+	if (len > PRINT_CLI_TxFree(tx))
+	{
+		// Drop the whole message so the host never sees half a line
+		tx->stats.overflow++;
+		tx->stats.dropped_bytes += len;
+		return 0;
+	}
+
+	uint16_t start = tx->head & TX_MASK;
+	uint16_t first = PRINT_CLI_TX_SIZE - start;
+	if (first > len)
+	{
+		first = len;
+	}
+	memcpy(&tx->ring[start], data, first);
+	memcpy(&tx->ring[0], data + first, len - first);
+
+	tx->head += len;
+	tx->stats.bytes_queued += len;
+
+	PRINT_CLI_Flush(tx);
+	return len;
+}
+
+static uint16_t PRINT_CLI_Out(cli_t *cli, const uint8_t *data, uint16_t len)
+{
+	print_cli_tx_t *tx = &cli->tx;
+	if (tx->capture_buf != NULL)
+	{
+		uint16_t room = tx->capture_size - tx->capture_len;
+		if (len > room)
+		{
+			tx->stats.truncated++;
+			len = room;
+		}
+		memcpy(&tx->capture_buf[tx->capture_len], data, len);
+		tx->capture_len += len;
+		return len;
+	}
+
+	return cli->sink(cli->sink_ctx, data, len);
+}
+
+/**
+ * @brief Send raw bytes to the console being serviced
+ * @param data: Bytes to send
+ * @param len: Number of bytes
+ * @return uint16_t: Number of bytes accepted
+ */
+uint16_t PRINT_CLI_Write(const uint8_t *data, uint16_t len)
+{
+	cli_t *cli = cli_current;
+	if (cli == NULL)
+	{
+		return 0;
+	}
+
+	CLI_PERF_MARK(start);
+	uint16_t written = PRINT_CLI_Out(cli, data, len);
+	CLI_PERF_OUTPUT(cli, start, written);
+	return written;
+}
 
 void PRINT_CLI(char *str, ...)
 {
+	cli_t *cli = cli_current;
+	if (cli == NULL)
+	{
+		return;
+	}
+
+	CLI_PERF_MARK(start);
 	char stringArray [BUFFER_UART];
 	va_list args;
 	va_start(args, str);
-	uint8_t len_str = vsprintf(stringArray, str, args);
+	int len_str = vsnprintf(stringArray, sizeof(stringArray), str, args);
 	va_end(args);
 
-	HAL_UART_Transmit(&huart1, (uint8_t*) stringArray, len_str, 100);
+	if (len_str < 0)
+	{
+		return;
+	}
+	if (len_str >= (int) sizeof(stringArray))
+	{
+		cli->tx.stats.truncated++;
+		len_str = sizeof(stringArray) - 1;
+	}
+
+	uint16_t written = PRINT_CLI_Out(cli, (uint8_t*) stringArray, (uint16_t) len_str);
+	CLI_PERF_OUTPUT(cli, start, written);
+	(void) written;
+}
+
+/**
+ * @brief Number of bytes that can be queued on a TX ring right now
+ */
+uint16_t PRINT_CLI_TxFree(print_cli_tx_t *tx)
+{
+	return PRINT_CLI_TX_SIZE - (uint16_t)(tx->head - tx->tail);
+}
+
+/**
+ * @brief Start draining a TX ring if no transfer is in progress
+ */
+void PRINT_CLI_Flush(print_cli_tx_t *tx)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	PRINT_CLI_Kick(tx);
+	__set_PRIMASK(primask);
+}
+
+/**
+ * @brief Release the finished chunk and chain the next one
+ * @note Called from HAL_UART_TxCpltCallback. If the finished transfer was not ours (e.g.
+ *       DataTrans on the same UART) the ring is only restarted.
+ * @param tx: TX state of the console whose UART finished transmitting
+ */
+void PRINT_CLI_TxComplete(print_cli_tx_t *tx)
+{
+	if (tx->len != 0)
+	{
+		tx->tail += tx->len;
+		tx->stats.bytes_sent += tx->len;
+		tx->len = 0;
+	}
+	PRINT_CLI_Kick(tx);
+}
 
+/**
+ * @brief Read the TX statistics of a console
+ * @param tx: TX state of the console
+ * @param stats: Destination for a snapshot of the counters
+ */
+void PRINT_CLI_GetStats(print_cli_tx_t *tx, print_cli_stats_t *stats)
+{
+	if (tx == NULL || stats == NULL)
+	{
+		return;
+	}
+	*stats = tx->stats;
+}
+
+/**
+ * @brief Redirect all following output of the current console into a buffer
+ * @param buf: Destination buffer
+ * @param size: Size of the buffer, output beyond it is cut and counted as truncated
+ */
+void PRINT_CLI_CaptureBegin(uint8_t *buf, uint16_t size)
+{
+	if (cli_current == NULL)
+	{
+		return;
+	}
+	cli_current->tx.capture_buf = buf;
+	cli_current->tx.capture_size = size;
+	cli_current->tx.capture_len = 0;
+}
+
+/**
+ * @brief Stop redirecting output and return to the console sink
+ * @return uint16_t: Number of bytes captured since PRINT_CLI_CaptureBegin
+ */
+uint16_t PRINT_CLI_CaptureEnd(void)
+{
+	if (cli_current == NULL)
+	{
+		return 0;
+	}
+	uint16_t len = cli_current->tx.capture_len;
+	cli_current->tx.capture_buf = NULL;
+	cli_current->tx.capture_size = 0;
+	cli_current->tx.capture_len = 0;
+	return len;
 }
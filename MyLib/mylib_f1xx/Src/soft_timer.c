@@ -0,0 +1,134 @@
+#include "soft_timer.h"
+
+static SoftTimer_t* soft_timer_head;        // Earliest deadline first
+
+/**
+ * @brief Unlink a timer, interrupts must be masked
+ * @param timer: Pointer to the timer
+ */
+static void SoftTimer_Unlink(SoftTimer_t* timer) {
+    SoftTimer_t** link = &soft_timer_head;
+
+    while (*link != NULL && *link != timer) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = timer->next;
+    }
+    timer->next = NULL;
+    timer->active = 0;
+}
+
+/**
+ * @brief Initialize a software timer
+ * @param timer: Pointer to the timer
+ * @param callback: Function run from SoftTimer_Process when the deadline expires
+ * @param context: Free pointer for the callback (e.g., the owning object)
+ */
+void SoftTimer_Init(SoftTimer_t* timer, void (*callback)(SoftTimer_t*, uint32_t), void* context) {
+    if (timer == NULL) return;
+
+    timer->next = NULL;
+    timer->deadline = 0;
+    timer->active = 0;
+    timer->callback = callback;
+    timer->context = context;
+}
+
+/**
+ * @brief Arm (or re-arm) a timer
+ * @note Safe from interrupts. Deadlines compare with wrap-around, so they must be less than
+ *       2^31 ticks away.
+ * @param timer: Pointer to the timer
+ * @param deadline: Absolute tick of expiry
+ */
+void SoftTimer_Start(SoftTimer_t* timer, uint32_t deadline) {
+    if (timer == NULL) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (timer->active) {
+        SoftTimer_Unlink(timer);
+    }
+
+    SoftTimer_t** link = &soft_timer_head;
+    while (*link != NULL && (int32_t)((*link)->deadline - deadline) <= 0) {
+        link = &(*link)->next;
+    }
+    timer->deadline = deadline;
+    timer->next = *link;
+    timer->active = 1;
+    *link = timer;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Disarm a timer, nothing happens if it is not armed
+ * @param timer: Pointer to the timer
+ */
+void SoftTimer_Stop(SoftTimer_t* timer) {
+    if (timer == NULL) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (timer->active) {
+        SoftTimer_Unlink(timer);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Run the callback of the earliest timer if it has expired
+ * @note For callers that need to act between callbacks, e.g. to drain an event queue
+ * @param current_tick: Current system tick
+ * @return uint8_t: 1 if a timer expired, 0 if none is due
+ */
+uint8_t SoftTimer_ProcessOne(uint32_t current_tick) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    SoftTimer_t* timer = soft_timer_head;
+    if (timer == NULL || (int32_t)(current_tick - timer->deadline) < 0) {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    SoftTimer_Unlink(timer);
+    __set_PRIMASK(primask);
+
+    if (timer->callback != NULL) {
+        timer->callback(timer, current_tick);
+    }
+    return 1;
+}
+
+/**
+ * @brief Run the callbacks of all expired timers
+ * @note Call from the main loop. Only the head of the list is compared, so the cost is
+ *       one comparison when nothing is due. Callbacks may re-arm their own timer.
+ * @param current_tick: Current system tick
+ */
+void SoftTimer_Process(uint32_t current_tick) {
+    while (SoftTimer_ProcessOne(current_tick)) {
+    }
+}
+
+/**
+ * @brief Get the earliest armed deadline
+ * @note Used by Button_Sleep: a pending deadline needs the tick running
+ * @param deadline: Destination for the deadline, can be NULL
+ * @return uint8_t: 1 if a timer is armed, 0 otherwise
+ */
+uint8_t SoftTimer_Next(uint32_t* deadline) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    SoftTimer_t* timer = soft_timer_head;
+    if (timer != NULL && deadline != NULL) {
+        *deadline = timer->deadline;
+    }
+
+    __set_PRIMASK(primask);
+    return timer != NULL;
+}
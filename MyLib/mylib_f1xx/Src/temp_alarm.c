@@ -0,0 +1,207 @@
+#include "temp_alarm.h"
+#include "cfg_store.h"
+#include "print_cli.h"
+#include "cli_rpc.h"
+#include "uart.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if (TEMP_ALARM_QUEUE & (TEMP_ALARM_QUEUE - 1)) != 0
+#error "TEMP_ALARM_QUEUE must be a power of two"
+#endif
+
+static temp_alarm_channel_t alarm_channel[TEMP_CHANNELS];
+static temp_alarm_event_t alarm_queue[TEMP_ALARM_QUEUE];
+static uint16_t alarm_head;
+static uint16_t alarm_tail;
+static uint32_t alarm_dropped;
+
+static const char *const alarm_event_name[] = { "HIGH", "HIGH clear", "LOW", "LOW clear" };
+static const char *const alarm_state_name[] = { "normal", "HIGH", "LOW" };
+
+static void TempAlarm_Push(uint8_t channel, uint8_t event, int16_t value, uint32_t tick)
+{
+	if ((uint16_t)(alarm_head - alarm_tail) >= TEMP_ALARM_QUEUE)
+	{
+		alarm_dropped++;
+		return;
+	}
+	temp_alarm_event_t *slot = &alarm_queue[alarm_head & (TEMP_ALARM_QUEUE - 1)];
+	slot->channel = channel;
+	slot->event = event;
+	slot->value = value;
+	slot->tick = tick;
+	alarm_head++;
+}
+
+/**
+ * @brief Move a channel to a new state once the debounce count is reached
+ * @return uint8_t: 1 if the state changed
+ */
+static uint8_t TempAlarm_Debounce(temp_alarm_channel_t *alarm, uint8_t toward)
+{
+	if (!toward)
+	{
+		alarm->pending = 0;
+		return 0;
+	}
+	if (++alarm->pending < TEMP_ALARM_DEBOUNCE)
+	{
+		return 0;
+	}
+	alarm->pending = 0;
+	return 1;
+}
+
+/**
+ * @brief Check a new sample of a channel against its limits
+ * @note Called by the acquisition for every filtered sample. The limits are the ones stored
+ *       by setTempMax/setTempMin (whole °C), a channel without limit never alarms on that side.
+ * @param channel: Channel 0..TEMP_CHANNELS-1
+ * @param value: Temperature (0.1 °C)
+ * @param tick: Tick of the sample
+ */
+void TempAlarm_Update(uint8_t channel, int16_t value, uint32_t tick)
+{
+	temp_alarm_channel_t *alarm = &alarm_channel[channel];
+	int16_t limit;
+
+	switch (alarm->state)
+	{
+		case TEMP_ALARM_NORMAL:
+		{
+			int16_t max, min;
+			uint8_t high = CfgStore_Get(CFG_KEY_TEMP_MAX + channel, &max) && value > max * 10;
+			uint8_t low = CfgStore_Get(CFG_KEY_TEMP_MIN + channel, &min) && value < min * 10;
+
+			if (TempAlarm_Debounce(alarm, high || low))
+			{
+				alarm->state = high ? TEMP_ALARM_HIGH : TEMP_ALARM_LOW;
+				alarm->since = tick;
+				alarm->count++;
+				TempAlarm_Push(channel, high ? TEMP_ALARM_EVT_HIGH_SET : TEMP_ALARM_EVT_LOW_SET, value, tick);
+			}
+			break;
+		}
+		case TEMP_ALARM_HIGH:
+			if (TempAlarm_Debounce(alarm, !CfgStore_Get(CFG_KEY_TEMP_MAX + channel, &limit) ||
+											value <= limit * 10 - TEMP_ALARM_HYST))
+			{
+				alarm->state = TEMP_ALARM_NORMAL;
+				alarm->alarm_ms += tick - alarm->since;
+				TempAlarm_Push(channel, TEMP_ALARM_EVT_HIGH_CLEAR, value, tick);
+			}
+			break;
+		case TEMP_ALARM_LOW:
+			if (TempAlarm_Debounce(alarm, !CfgStore_Get(CFG_KEY_TEMP_MIN + channel, &limit) ||
+											value >= limit * 10 + TEMP_ALARM_HYST))
+			{
+				alarm->state = TEMP_ALARM_NORMAL;
+				alarm->alarm_ms += tick - alarm->since;
+				TempAlarm_Push(channel, TEMP_ALARM_EVT_LOW_CLEAR, value, tick);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief Take the oldest alarm event
+ * @param event: Receives the event
+ * @return uint8_t: 1 if an event was returned, 0 if the queue is empty
+ */
+uint8_t TempAlarm_Pop(temp_alarm_event_t *event)
+{
+	if (alarm_tail == alarm_head)
+	{
+		return 0;
+	}
+	*event = alarm_queue[alarm_tail & (TEMP_ALARM_QUEUE - 1)];
+	alarm_tail++;
+	return 1;
+}
+
+const temp_alarm_channel_t* TempAlarm_Get(uint8_t channel)
+{
+	return (channel < TEMP_CHANNELS) ? &alarm_channel[channel] : NULL;
+}
+
+/**
+ * @brief Check a new max or min limit of a channel
+ * @note One rule for the CLI and Modbus: TEMP_LIMIT_LOW..TEMP_LIMIT_HIGH, and min <= max
+ *       when the channel has both
+ * @param channel: Channel 0..TEMP_CHANNELS-1
+ * @param is_min: 1 for the min limit, 0 for the max limit
+ * @param value: New limit (°C)
+ * @param other: Other limit of the channel when it changes in the same request, NULL to
+ *        compare with the stored one
+ * @return uint8_t: 1 if the limit may be stored
+ */
+uint8_t TempAlarm_CheckLimit(uint8_t channel, uint8_t is_min, int32_t value, const int16_t *other)
+{
+	int16_t stored;
+
+	if (channel >= TEMP_CHANNELS || value < TEMP_LIMIT_LOW || value > TEMP_LIMIT_HIGH)
+	{
+		return 0;
+	}
+	if (other == NULL && CfgStore_Get((is_min ? CFG_KEY_TEMP_MAX : CFG_KEY_TEMP_MIN) + channel, &stored))
+	{
+		other = &stored;
+	}
+	if (other != NULL && (is_min ? value > *other : value < *other))
+	{
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Number of events lost because nobody consumed the queue
+ */
+uint32_t TempAlarm_Dropped(void)
+{
+	return alarm_dropped;
+}
+
+/**
+ * @brief CLI command "alarm [events]": alarm state and time in alarm of every channel,
+ *        or the pending events
+ * @note An event is popped only once the TX ring has room for its line, as the perf dump
+ *       does. What does not fit stays queued and is counted as pending, the next
+ *       "alarm events" prints it.
+ */
+void tempAlarm(char **argv, uint8_t arr_token)
+{
+	if (arr_token == 2 && !strcmp(argv[1], "events"))
+	{
+		temp_alarm_event_t event;
+		while (PRINT_CLI_TxFree(&cli_current->tx) >= 2 * BUFFER_UART && TempAlarm_Pop(&event))
+		{
+			PRINT_CLI("%lu CHANNEL %u %s %s%d.%d\n", (unsigned long) event.tick, event.channel,
+					  alarm_event_name[event.event], (event.value < 0) ? "-" : "",
+					  abs(event.value) / 10, abs(event.value) % 10);
+		}
+		PRINT_CLI("pending %u, dropped %lu\n", (uint16_t)(alarm_head - alarm_tail), (unsigned long) alarm_dropped);
+		return;
+	}
+	if (arr_token != 1)
+	{
+		PRINT_CLI("Too much argument\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
+		return;
+	}
+
+	uint32_t now = HAL_GetTick();
+	for (uint8_t ch = 0; ch < TEMP_CHANNELS; ch++)
+	{
+		temp_alarm_channel_t *alarm = &alarm_channel[ch];
+		uint32_t total = alarm->alarm_ms + ((alarm->state != TEMP_ALARM_NORMAL) ? now - alarm->since : 0);
+		PRINT_CLI("CHANNEL %u: %s, alarms %lu, in alarm %lu ms\n", ch, alarm_state_name[alarm->state],
+				  (unsigned long) alarm->count, (unsigned long) total);
+	}
+}
+
+CLI_COMMAND(alarm, tempAlarm, "Trang thai canh bao nhiet do: alarm [events]");
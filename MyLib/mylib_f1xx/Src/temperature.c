@@ -0,0 +1,129 @@
+#include "temperature.h"
+#include "temp_alarm.h"
+
+#include <string.h>
+
+// Temperature (0.1 °C) at ADC code i << TEMP_LUT_SHIFT, the last point stands for code 4096
+static const int16_t temp_lut[(4096 >> TEMP_LUT_SHIFT) + 1] =
+{
+	1500, 1293, 1016,  866,  763,  685,  621,  567,
+	 520,  477,  439,  403,  369,  338,  308,  278,
+	 250,  222,  194,  167,  139,  111,   82,   53,
+	  22,  -12,  -47,  -87, -132, -186, -257, -365,
+	-550
+};
+
+static uint8_t temp_running;									// Temperature_Init started the DMA
+static uint16_t temp_raw[TEMP_SCANS][TEMP_CHANNELS];		// Filled continuously by circular DMA
+static int32_t temp_filter[TEMP_CHANNELS];					// IIR state, value << TEMP_FILTER_SHIFT
+static temp_cache_t temp_cache[TEMP_CHANNELS];
+static uint32_t temp_next_tick;
+
+/**
+ * @brief Convert an ADC code to a temperature
+ * @note Linear interpolation between two table points, integer only
+ * @param code: 12-bit ADC code
+ * @return int16_t: Temperature in 0.1 °C
+ */
+int16_t Temperature_FromAdc(uint16_t code)
+{
+	uint16_t index = code >> TEMP_LUT_SHIFT;
+	int32_t frac = code & ((1 << TEMP_LUT_SHIFT) - 1);
+	int32_t low = temp_lut[index];
+	int32_t high = temp_lut[index + 1];
+
+	return (int16_t)(low + (((high - low) * frac) >> TEMP_LUT_SHIFT));
+}
+
+/**
+ * @brief Start the background acquisition
+ * @note hadc must be configured for a continuous scan of TEMP_CHANNELS ranks with a
+ *       circular half-word DMA. Conversions then run without the CPU, the cache is
+ *       refreshed from Temperature_Process.
+ * @param hadc: ADC handle
+ * @return HAL_StatusTypeDef: Result of starting the DMA
+ */
+#ifdef HAL_ADC_MODULE_ENABLED
+HAL_StatusTypeDef Temperature_Init(ADC_HandleTypeDef *hadc)
+{
+	memset(temp_raw, 0, sizeof(temp_raw));
+	memset(temp_cache, 0, sizeof(temp_cache));
+
+	HAL_ADCEx_Calibration_Start(hadc);
+	HAL_StatusTypeDef status = HAL_ADC_Start_DMA(hadc, (uint32_t*) temp_raw, TEMP_SCANS * TEMP_CHANNELS);
+	temp_running = (status == HAL_OK);
+	return status;
+}
+#endif
+
+/**
+ * @brief Refresh the cache every TEMP_PERIOD
+ * @note Averages the scans held in the DMA buffer, converts and filters each channel
+ * @param tick: Current system tick
+ */
+void Temperature_Process(uint32_t tick)
+{
+	if (!temp_running || (int32_t)(tick - temp_next_tick) < 0)
+	{
+		return;
+	}
+	temp_next_tick = tick + TEMP_PERIOD;
+
+	for (uint8_t ch = 0; ch < TEMP_CHANNELS; ch++)
+	{
+		uint32_t sum = 0;
+		for (uint8_t scan = 0; scan < TEMP_SCANS; scan++)
+		{
+			sum += temp_raw[scan][ch];
+		}
+
+		temp_cache_t *cache = &temp_cache[ch];
+		cache->raw = sum / TEMP_SCANS;
+		int32_t sample = Temperature_FromAdc(cache->raw);
+
+		if (!cache->valid)
+		{
+			temp_filter[ch] = sample * (1 << TEMP_FILTER_SHIFT);
+			cache->valid = 1;
+		}
+		else
+		{
+			temp_filter[ch] += sample - (temp_filter[ch] >> TEMP_FILTER_SHIFT);
+		}
+		cache->value = temp_filter[ch] >> TEMP_FILTER_SHIFT;
+		cache->tick = tick;
+		TempAlarm_Update(ch, cache->value, tick);
+	}
+}
+
+/**
+ * @brief Read the latest filtered temperature of a channel
+ * @param channel: Channel 0..TEMP_CHANNELS-1
+ * @param value: Receives the temperature in 0.1 °C
+ * @param age: Receives the time since the value was updated (ms), may be NULL
+ * @return uint8_t: 1 if the channel has a value, 0 otherwise
+ */
+uint8_t Temperature_Get(uint8_t channel, int16_t *value, uint32_t *age)
+{
+	if (channel >= TEMP_CHANNELS || !temp_cache[channel].valid)
+	{
+		return 0;
+	}
+
+	*value = temp_cache[channel].value;
+	if (age != NULL)
+	{
+		*age = HAL_GetTick() - temp_cache[channel].tick;
+	}
+	return 1;
+}
+
+/**
+ * @brief Latest averaged ADC code of a channel, before linearisation
+ * @param channel: Channel 0..TEMP_CHANNELS-1
+ * @return uint16_t: 12-bit code, 0 if the channel has no value yet
+ */
+uint16_t Temperature_GetRaw(uint8_t channel)
+{
+	return (channel < TEMP_CHANNELS) ? temp_cache[channel].raw : 0;
+}
@@ -1,53 +1,143 @@
 #include "temperature_cli.h"
 #include "print_cli.h"
 #include "cli_types.h"
+#include "cli_rpc.h"
+#include "cfg_store.h"
+#include "temperature.h"
+#include "temp_alarm.h"
+
+/**
+ * @brief Print a cached temperature as "<deg>.<tenth> C (<age> ms)"
+ * @return uint8_t: 1 if the channel had a value
+ */
+static uint8_t printTemp(uint8_t channel)
+{
+	int16_t value;
+	uint32_t age;
+
+	if (!Temperature_Get(channel, &value, &age))
+	{
+		PRINT_CLI("chua co du lieu\n");
+		return 0;
+	}
+	PRINT_CLI("%s%d.%d C (%lu ms)\n", (value < 0) ? "-" : "", abs(value) / 10, abs(value) % 10, (unsigned long) age);
+	return 1;
+}
 
 void getTemp(char **argv, uint8_t arr_token)
 {
 	if (arr_token != 2)
 	{
 		PRINT_CLI("Too much argument\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
+		return;
+	}
+	int channel = atoi(argv[1]);
+	if (channel < 0 || channel >= TEMP_CHANNELS)
+	{
+		PRINT_CLI("CHANNEL Error\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
 		return;
 	}
-	PRINT_CLI("Nhiet do hien tai CHANNEL %d: \n", atoi(argv[1]));
+
+	// Reads the cache filled in the background, never waits for a conversion
+	PRINT_CLI("Nhiet do hien tai CHANNEL %d: ", channel);
+	int16_t value;
+	if (Temperature_Get(channel, &value, NULL))
+	{
+		CLI_RPC_ReplyInt(value);
+	}
+	else
+	{
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_ERROR);
+	}
+	printTemp(channel);
 }
 
-void setTempMax(char **argv, uint8_t arr_token)
+/**
+ * @brief Common part of setTempMax and setTempMin
+ * @note Checked with TempAlarm_CheckLimit, the rule Modbus uses for the same registers
+ */
+static void setTempLimit(char **argv, uint8_t arr_token, uint8_t is_min)
 {
 	if (arr_token != 3)
 	{
 		PRINT_CLI("Too much argument\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
 		return;
 	}
-	if (atoi(argv[1])  > 5 )
+	int channel = atoi(argv[1]);
+	int value = atoi(argv[2]);
+	if (channel < 0 || channel >= TEMP_CHANNELS)
 	{
 		PRINT_CLI("CHANNEL Error\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
 		return;
 	}
-	if (atoi(argv[2])  > 100 )
+	if (value < TEMP_LIMIT_LOW || value > TEMP_LIMIT_HIGH)
 	{
 		PRINT_CLI("Temperature Error\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
+		return;
+	}
+	if (!TempAlarm_CheckLimit(channel, is_min, value, NULL))
+	{
+		PRINT_CLI("Temperature Error: min > max\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_BAD_ARGS);
 		return;
 	}
-	PRINT_CLI("Cai Nhiet Do Max CHANNEL %d: %d \n", atoi(argv[1]), atoi(argv[2]));
+	if (CfgStore_Set((is_min ? CFG_KEY_TEMP_MIN : CFG_KEY_TEMP_MAX) + channel, value) != HAL_OK)
+	{
+		PRINT_CLI("Loi luu cau hinh, gia tri chua duoc ghi flash (xem cfg)\n");
+		CLI_RPC_SetStatus(CLI_RPC_STATUS_ERROR);
+	}
+	PRINT_CLI("Cai Nhiet Do %s CHANNEL %d: %d \n", is_min ? "Min" : "Max", channel, value);
+}
+
+void setTempMax(char **argv, uint8_t arr_token)
+{
+	setTempLimit(argv, arr_token, 0);
 }
 
 void setTempMin(char **argv, uint8_t arr_token)
 {
-	if (arr_token != 3)
+	setTempLimit(argv, arr_token, 1);
+}
+
+/**
+ * @brief Resumable command "sampleTemp <channel> <count> <interval_ms>"
+ * @note Prints one sample per interval without blocking the main loop, Ctrl-C stops it
+ */
+cli_task_status_t sampleTemp(cli_task_t *task)
+{
+	// var[0]: samples printed, var[1]: tick of the next sample
+	CLI_PT_BEGIN(task);
+
+	if (task->arr_token != 4)
 	{
 		PRINT_CLI("Too much argument\n");
-		return;
+		return CLI_TASK_DONE;
 	}
-	if (atoi(argv[1])  > 5 )
+	if (atoi(task->argv[1]) < 0 || atoi(task->argv[1]) > 5)
 	{
 		PRINT_CLI("CHANNEL Error\n");
-		return;
+		return CLI_TASK_DONE;
 	}
-	if (atoi(argv[2])  < - 100 )
+
+	task->var[1] = HAL_GetTick();
+	while (task->var[0] < (uint32_t) atoi(task->argv[2]))
 	{
-		PRINT_CLI("Temperature Error\n");
-		return;
+		CLI_PT_WAIT_UNTIL(task, (int32_t)(HAL_GetTick() - task->var[1]) >= 0);
+		PRINT_CLI("Nhiet do CHANNEL %d mau %lu: ", atoi(task->argv[1]), (unsigned long) task->var[0]);
+		printTemp(atoi(task->argv[1]));
+		task->var[0]++;
+		task->var[1] += atoi(task->argv[3]);
 	}
-	PRINT_CLI("Cai Nhiet Do Min CHANNEL %d: %d \n", atoi(argv[1]), atoi(argv[2]));
+
+	CLI_PT_END(task);
 }
+
+CLI_COMMAND(getTemp, getTemp, "Cai dat nhiet do");
+CLI_COMMAND(setTempMax, setTempMax, "Cai Nhiet Do Max");
+CLI_COMMAND(setTempMin, setTempMin, "Cai Nhiet Do Min");
+CLI_COMMAND_STEP(sampleTemp, sampleTemp, "Lay mau nhiet do lien tuc: sampleTemp <kenh> <so mau> <ms>");
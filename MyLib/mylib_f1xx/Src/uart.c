@@ -1,37 +1,223 @@
 #include "uart.h"
+#include "data_trans.h"
 
-uint8_t data_rx;
-uint8_t buff[BUFFER_UART];
-uint8_t index_uart;
-uint8_t Flag_UART;
+#if (UART_RX_QUEUE & (UART_RX_QUEUE - 1)) != 0
+#error "UART_RX_QUEUE must be a power of two"
+#endif
+
+cli_t *cli_current;
+
+static cli_t *cli_ports[UART_PORT_MAX];		// Indexed by USART number for O(1) lookup in the interrupts
+static cli_t *cli_primary;					// First console, receives output printed outside CLI_Handle
+static cli_t cli_default;					// Console used by UART_Init/UART_HANDLE
+static UART_RX_HOOK_T uart_rx_hook;			// Receives the UARTs without a console
+
+static int8_t UART_PortIndex(USART_TypeDef *instance)
+{
+	if (instance == USART1) return 0;
+	if (instance == USART2) return 1;
+	if (instance == USART3) return 2;
+	return -1;
+}
+
+/**
+ * @brief Find the console attached to a UART
+ * @param huart: UART handle
+ * @return cli_t*: Console, NULL if the UART has none
+ */
+cli_t* CLI_FromUart(UART_HandleTypeDef *huart)
+{
+	int8_t index = UART_PortIndex(huart->Instance);
+	return (index < 0) ? NULL : cli_ports[index];
+}
+
+/**
+ * @brief Hand the receive interrupt of the UARTs without a console to another protocol
+ * @note Set by Modbus_Init, the CLI core does not depend on the protocols behind it
+ * @param hook: Called from HAL_UART_RxCpltCallback, NULL to remove it
+ */
+void UART_SetRxHook(UART_RX_HOOK_T hook)
+{
+	uart_rx_hook = hook;
+}
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
-	if (huart->Instance == huart1.Instance)
+	cli_t *cli = CLI_FromUart(huart);
+	if (cli == NULL)
 	{
-		buff[index_uart++] = data_rx;
-		if (data_rx == '\n')
+		if (uart_rx_hook != NULL)
 		{
-			Flag_UART = 1;
+			uart_rx_hook(huart);
+		}
+		return;
+	}
+
+	uint8_t data = cli->data_rx;
+	HAL_UART_Receive_IT(huart, &cli->data_rx, sizeof(cli->data_rx));
+	CLI_RxByte(cli, data);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	cli_t *cli = CLI_FromUart(huart);
+	if (cli != NULL)
+	{
+		PRINT_CLI_TxComplete(&cli->tx);
+	}
+	DataTrans_HandleTxComplete(huart);
+}
 
+/**
+ * @brief Attach a console to a UART and start receiving
+ * @param cli: Console object, owned by the caller
+ * @param huart: UART the console runs on (USART1..USART3)
+ * @param commands: Command table, terminated by an entry with a NULL name
+ */
+void CLI_Init(cli_t *cli, UART_HandleTypeDef *huart, const cli_command_t *commands)
+{
+	int8_t index = UART_PortIndex(huart->Instance);
+	if (index < 0)
+	{
+		return;
+	}
+
+	memset(cli, 0, sizeof(*cli));
+	cli->huart = huart;
+	cli->commands = commands;
+	cli->commands_sorted = 1;
+	while (commands[cli->command_count].cmd_name != NULL)
+	{
+		if (cli->command_count > 0 &&
+			strcmp(commands[cli->command_count - 1].cmd_name, commands[cli->command_count].cmd_name) >= 0)
+		{
+			cli->commands_sorted = 0;
 		}
-		HAL_UART_Receive_IT(&huart1, &data_rx, sizeof(data_rx));
+		cli->command_count++;
 	}
+	CLI_Stream_Reset(cli);
+	PRINT_CLI_TxInit(&cli->tx, huart);
+	cli->sink = PRINT_CLI_TxWrite;
+	cli->sink_ctx = &cli->tx;
+	cli->task.budget_us = CLI_TASK_BUDGET_US;
+#if CLI_PERF_ENABLE
+	CLI_CYCLES_ENABLE();
+#endif
+
+	cli_ports[index] = cli;
+	if (cli_primary == NULL)
+	{
+		cli_primary = cli;
+		cli_current = cli;
+	}
+
+	HAL_UART_Receive_IT(huart, &cli->data_rx, sizeof(cli->data_rx));
+}
+
+/**
+ * @brief Redirect the output of a console
+ * @param cli: Console
+ * @param sink: Function receiving every byte printed on the console
+ * @param ctx: Context passed to the sink
+ */
+void CLI_SetSink(cli_t *cli, CLI_SINK_FUN_T sink, void *ctx)
+{
+	cli->sink = sink;
+	cli->sink_ctx = ctx;
+}
+
+/**
+ * @brief Hand one received byte to a console
+ * @note Called from the RX interrupt, and by CLI_Replay_Run to inject recorded traffic.
+ *       The byte is only queued with its arrival tick, CLI_Handle decides what it means.
+ * @param cli: Console
+ * @param data: Received byte
+ */
+void CLI_RxByte(cli_t *cli, uint8_t data)
+{
+	uint8_t *record = cli->record_buf;
+	if (record != NULL && cli->record_len < cli->record_size)
+	{
+		record[cli->record_len++] = data;
+	}
+
+	uint16_t depth = (uint16_t)(cli->rx_head - cli->rx_tail);
+	if (depth >= UART_RX_QUEUE)
+	{
+		cli->rx_dropped++;
+		return;
+	}
+	cli->rx_queue[cli->rx_head & (UART_RX_QUEUE - 1)] = data;
+	cli->rx_tick[cli->rx_head & (UART_RX_QUEUE - 1)] = (uint16_t) HAL_GetTick();
+	cli->rx_head++;
+	if (depth + 1 > cli->rx_peak)
+	{
+		cli->rx_peak = depth + 1;
+	}
+}
+
+/**
+ * @brief Service one console: received bytes, running command and watches
+ * @param cli: Console to service
+ */
+void CLI_Handle(cli_t *cli)
+{
+	cli_current = cli;
+
+	while (cli->rx_tail != cli->rx_head)
+	{
+		uint8_t data = cli->rx_queue[cli->rx_tail & (UART_RX_QUEUE - 1)];
+		uint16_t tick = cli->rx_tick[cli->rx_tail & (UART_RX_QUEUE - 1)];
+		cli->rx_tail++;
+
+		// Ctrl-C is told from frame data here, in order: a "rpc" still queued ahead of it
+		// switches the console before the byte is looked at
+		if (cli->rpc.active)
+		{
+			CLI_RPC_RxByte(cli, data, tick);
+		}
+		else if (data == CLI_TASK_CANCEL_KEY)
+		{
+			cli->cancel = 1;
+		}
+		else if (cli->edit.interactive)
+		{
+			CLI_Edit_Byte(cli, data);
+		}
+		else
+		{
+			CLI_Stream_Byte(cli, data);
+		}
+	}
+
+	if (cli->cancel)
+	{
+		cli->cancel = 0;
+		CLI_Task_Cancel(cli);
+		CLI_Watch_StopAll(cli);
+	}
+	CLI_Task_Run(cli);
+	if (!cli->rpc.active)
+	{
+		CLI_Watch_Process(cli, HAL_GetTick());	// Text output would corrupt the binary frames
+	}
+	PRINT_CLI_Flush(&cli->tx);			// Restart the ring if the UART was busy when it was filled
+
+	cli_current = cli_primary;
 }
 
 void UART_Init(UART_HandleTypeDef *huart)
 {
-	HAL_UART_Receive_IT(huart, &data_rx, sizeof(data_rx));
+	CLI_Init(&cli_default, huart, CLI_Commands());
 }
 
 void UART_HANDLE()
 {
-	if (Flag_UART)
+	for (uint8_t i = 0; i < UART_PORT_MAX; i++)
 	{
-		COMMAND_EXCUTE((char*) buff, index_uart);
-		memset(buff, 0, sizeof(buff));
-		index_uart = 0;
-		Flag_UART = 0;
+		if (cli_ports[i] != NULL)
+		{
+			CLI_Handle(cli_ports[i]);
+		}
 	}
-
 }